@@ -0,0 +1,624 @@
+// Пакетная проверка партий (PGN) и позиций (FEN/EPD).
+//
+//   analyze [-t N] [-q] [-o архив] [--pgn | --fen] <файл>
+//   analyze --check
+//
+// Файл отображается в память и делится на части по границам партий (строк),
+// части разбираются параллельно без копирования текста; результаты частей
+// выводятся (и дописываются в архив) по мере готовности, в порядке файла. Для каждой партии
+// выводится строка "смещение<TAB>итог<TAB>полуходы<TAB>итоговый FEN", где итог -
+// ok, mate, stalemate, fifty (правило 50 ходов), repetition (троекратное
+// повторение), illegal:<ход> или badfen. Сводка и скорость - в stderr.
+// Формат определяется по расширению (.fen, .epd - позиции, иначе PGN).
+// С ключом -o допустимые партии (позиции - как партии без ходов) сохраняются
+// в двоичный архив (GameArchive.h). --check прогоняет встроенные некорректные
+// партии PGN (обрывы тегов, комментариев и вариантов, искаженные ходы)
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ChessBoard.h"
+#include "GameArchive.h"
+#include "MappedFile.h"
+
+using namespace std;
+
+namespace {
+
+const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Частей больше, чем потоков: свободный поток берет следующую часть. Часть не
+// крупнее SHARD_BYTES, и в работе или в ожидании вывода не больше
+// SHARDS_IN_FLIGHT частей на поток, поэтому память не растет с размером файла
+const int SHARDS_PER_THREAD = 8;
+const size_t SHARD_BYTES = size_t(4) << 20;
+const int SHARDS_IN_FLIGHT = 4;
+
+enum class Format { PGN, FEN };
+
+struct Options {
+    bool quiet = false;       // Только сводка
+    bool archive = false;     // Собирать допустимые партии для двоичного архива
+};
+
+// Результаты одной части файла
+struct ShardResult {
+    string output;            // Строки по партиям в порядке следования в файле
+    uint64_t games = 0;
+    uint64_t plies = 0;
+    uint64_t illegal = 0;
+    uint64_t mates = 0;
+    uint64_t stalemates = 0;
+    uint64_t ruleDraws = 0;   // Правило 50 ходов и троекратное повторение
+    uint64_t badFen = 0;
+    uint64_t unpackable = 0;  // Допустимые партии, не попавшие в архив (больше 32 фигур)
+    string archive;           // Партии в формате архива (ArchiveWriter::encodeGame)
+    vector<Move> moves;       // Ходы текущей партии
+
+    void merge(const ShardResult& other) {
+        games += other.games;
+        plies += other.plies;
+        illegal += other.illegal;
+        mates += other.mates;
+        stalemates += other.stalemates;
+        ruleDraws += other.ruleDraws;
+        badFen += other.badFen;
+        unpackable += other.unpackable;
+    }
+
+    // Очистка после вывода; буферы сохраняют память для следующей части
+    void reset() {
+        output.clear();
+        archive.clear();
+        games = plies = illegal = mates = stalemates = ruleDraws = badFen = unpackable = 0;
+    }
+};
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool atLineStart(const char* begin, const char* p) {
+    return p == begin || p[-1] == '\n';
+}
+
+bool isResult(string_view token) {
+    return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+GameResult parseResult(string_view token) {
+    if (token == "1-0") {
+        return GameResult::WHITE_WINS;
+    }
+    if (token == "0-1") {
+        return GameResult::BLACK_WINS;
+    }
+    return token == "1/2-1/2" ? GameResult::DRAW : GameResult::UNKNOWN;
+}
+
+// Начало первой партии PGN не раньше pos: строка с тегом, перед которой
+// стоит не тег (пустая строка или текст ходов предыдущей партии)
+size_t findGameStart(const char* data, size_t size, size_t pos) {
+    while (pos > 0 && pos < size && data[pos - 1] != '\n') {
+        ++pos;
+    }
+    while (pos < size) {
+        if (data[pos] == '[') {
+            // Предыдущая непустая строка
+            size_t p = pos;
+            while (p > 0 && isSpace(data[p - 1])) {
+                --p;
+            }
+            size_t lineStart = p;
+            while (lineStart > 0 && data[lineStart - 1] != '\n') {
+                --lineStart;
+            }
+            if (p == 0 || data[lineStart] != '[') {
+                return pos;
+            }
+        }
+        const void* next = memchr(data + pos, '\n', size - pos);
+        pos = next ? size_t(static_cast<const char*>(next) - data) + 1 : size;
+    }
+    return size;
+}
+
+// Начало первой строки не раньше pos
+size_t findLineStart(const char* data, size_t size, size_t pos) {
+    if (pos == 0) {
+        return 0;
+    }
+    const void* next = memchr(data + pos - 1, '\n', size - pos + 1);
+    return next ? size_t(static_cast<const char*>(next) - data) + 1 : size;
+}
+
+// Итог партии или позиции одной строкой
+void report(ShardResult& result, size_t offset, const string& status, int plies, string_view fen, const Options& options) {
+    if (options.quiet) {
+        return;
+    }
+    result.output += to_string(offset);
+    result.output += '\t';
+    result.output += status;
+    result.output += '\t';
+    result.output += to_string(plies);
+    result.output += '\t';
+    result.output += fen;
+    result.output += '\n';
+}
+
+void report(ShardResult& result, size_t offset, const string& status, int plies, const ChessBoard& board, const Options& options) {
+    if (!options.quiet) {
+        report(result, offset, status, plies, board.toFen(), options);
+    }
+}
+
+// Итог по позиции, в которой партия остановилась
+void finishPosition(ShardResult& result, size_t offset, int plies, const ChessBoard& board, const Options& options) {
+    Color side = board.sideToMove();
+    if (board.isCheckmate(side)) {
+        ++result.mates;
+        report(result, offset, "mate", plies, board, options);
+    }
+    else if (board.isStalemate(side)) {
+        ++result.stalemates;
+        report(result, offset, "stalemate", plies, board, options);
+    }
+    else if (board.isDrawByRule()) {
+        ++result.ruleDraws;
+        report(result, offset, board.halfmoveClock() >= 100 ? "fifty" : "repetition", plies, board, options);
+    }
+    else {
+        report(result, offset, "ok", plies, board, options);
+    }
+}
+
+// Разбор одной партии PGN с позиции p; возвращает конец партии
+const char* analyzeGame(const char* data, const char* p, const char* end, ChessBoard& board,
+                        const ChessBoard& startBoard, ShardResult& result, const Options& options) {
+    size_t offset = size_t(p - data);
+    string_view fen;
+
+    // Теги: из них нужна только начальная позиция [FEN "..."]
+    while (p < end && *p == '[') {
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', size_t(end - p)));
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+        string_view tag(p, size_t(lineEnd - p));
+        if (tag.compare(0, 5, "[FEN ") == 0) {
+            size_t open = tag.find('"');
+            size_t close = tag.rfind('"');
+            if (open != string_view::npos && close > open) {
+                fen = tag.substr(open + 1, close - open - 1);
+            }
+        }
+        p = lineEnd < end ? lineEnd + 1 : end;
+        while (p < end && isSpace(*p)) {
+            ++p;
+        }
+    }
+
+    ++result.games;
+    bool valid = true;
+    if (fen.empty()) {
+        board = startBoard;
+    }
+    else if (!board.loadFen(string(fen))) {
+        valid = false;
+        ++result.badFen;
+        report(result, offset, "badfen", 0, fen, options);
+    }
+    PackedPosition start;
+    bool packed = board.pack(start);
+    result.moves.clear();
+
+    // Текст ходов: до результата партии или до тегов следующей партии
+    int plies = 0;
+    string illegalMove;
+    GameResult outcome = GameResult::UNKNOWN;
+    while (p < end) {
+        char c = *p;
+        if (isSpace(c)) {
+            ++p;
+        }
+        else if (c == '[' && atLineStart(data, p)) {
+            break;
+        }
+        else if (c == '{') {
+            const char* close = static_cast<const char*>(memchr(p, '}', size_t(end - p)));
+            p = close ? close + 1 : end;
+        }
+        else if (c == ';') {
+            const char* lineEnd = static_cast<const char*>(memchr(p, '\n', size_t(end - p)));
+            p = lineEnd ? lineEnd + 1 : end;
+        }
+        else if (c == '(') {
+            // Варианты (могут быть вложенными и содержать комментарии) пропускаются
+            int depth = 0;
+            while (p < end) {
+                if (*p == '{') {
+                    const char* close = static_cast<const char*>(memchr(p, '}', size_t(end - p)));
+                    p = close ? close : end - 1;
+                }
+                else if (*p == '(') {
+                    ++depth;
+                }
+                else if (*p == ')' && --depth == 0) {
+                    ++p;
+                    break;
+                }
+                ++p;
+            }
+        }
+        else if (c == '$' || c == ')') {
+            ++p;
+            while (p < end && *p >= '0' && *p <= '9') {
+                ++p;
+            }
+        }
+        else {
+            const char* start = p;
+            while (p < end && !isSpace(*p) && !strchr("{}();[", *p)) {
+                ++p;
+            }
+            if (p == start) {
+                ++p; // Одиночный служебный символ вне своего места
+                continue;
+            }
+            string_view token(start, size_t(p - start));
+            if (isResult(token)) {
+                outcome = parseResult(token);
+                break;
+            }
+
+            // Номер хода ("12." или "12...") может быть записан слитно с ходом
+            size_t skip = 0;
+            while (skip < token.size() && ((token[skip] >= '0' && token[skip] <= '9') || token[skip] == '.')) {
+                ++skip;
+            }
+            if (skip > 0 && skip < token.size() && token[skip - 1] != '.') {
+                skip = 0;
+            }
+            token.remove_prefix(skip);
+            if (token.empty() || !valid) {
+                continue;
+            }
+
+            Move move = board.parseSan(token);
+            if (move == MOVE_NONE) {
+                valid = false;
+                illegalMove = string(token);
+                continue;
+            }
+            board.makeMove(move);
+            ++plies;
+            if (options.archive) {
+                result.moves.push_back(move);
+            }
+        }
+    }
+
+    // После результата пропускаем хвост строки
+    while (p < end && !(*p == '[' && atLineStart(data, p))) {
+        ++p;
+    }
+
+    result.plies += uint64_t(plies);
+    if (!illegalMove.empty()) {
+        ++result.illegal;
+        report(result, offset, "illegal:" + illegalMove, plies, board, options);
+    }
+    else if (valid) {
+        finishPosition(result, offset, plies, board, options);
+
+        // В архив попадают только партии без ошибок; итог без тега - по доске
+        if (options.archive && !packed) {
+            ++result.unpackable;
+        }
+        else if (options.archive) {
+            if (outcome == GameResult::UNKNOWN && board.isCheckmate(board.sideToMove())) {
+                outcome = board.sideToMove() == Color::WHITE ? GameResult::BLACK_WINS : GameResult::WHITE_WINS;
+            }
+            else if (outcome == GameResult::UNKNOWN
+                     && (board.isStalemate(board.sideToMove()) || board.isDrawByRule())) {
+                outcome = GameResult::DRAW;
+            }
+            ArchiveWriter::encodeGame(result.archive, start, result.moves.data(), int(result.moves.size()), outcome);
+        }
+    }
+    return p;
+}
+
+void analyzePgn(const char* data, size_t begin, size_t end, ShardResult& result, const Options& options) {
+    ChessBoard startBoard;
+    startBoard.loadFen(START_FEN);
+    ChessBoard board = startBoard;
+
+    const char* p = data + begin;
+    const char* stop = data + end;
+    while (p < stop) {
+        while (p < stop && isSpace(*p)) {
+            ++p;
+        }
+        if (p < stop) {
+            p = analyzeGame(data, p, stop, board, startBoard, result, options);
+        }
+    }
+}
+
+void analyzeFen(const char* data, size_t begin, size_t end, ShardResult& result, const Options& options) {
+    ChessBoard board;
+    string fen;
+    size_t pos = begin;
+    while (pos < end) {
+        const void* next = memchr(data + pos, '\n', end - pos);
+        size_t lineEnd = next ? size_t(static_cast<const char*>(next) - data) : end;
+        fen.assign(data + pos, lineEnd - pos);
+
+        if (fen.find_first_not_of(" \t\r") != string::npos) {
+            ++result.games;
+            if (board.loadFen(fen)) {
+                finishPosition(result, pos, 0, board, options);
+                PackedPosition packed;
+                if (options.archive && !board.pack(packed)) {
+                    ++result.unpackable;
+                }
+                else if (options.archive) {
+                    ArchiveWriter::encodeGame(result.archive, packed, nullptr, 0, GameResult::UNKNOWN);
+                }
+            }
+            else {
+                ++result.badFen;
+                report(result, pos, "badfen", 0, fen, options);
+            }
+        }
+        pos = lineEnd + 1;
+    }
+}
+
+// Некорректные партии для --check: разбор не должен выходить за пределы текста,
+// счетчики итогов должны совпасть с ожидаемыми
+struct PgnCase {
+    const char* name;
+    const char* pgn;
+    uint64_t games;
+    uint64_t illegal;
+    uint64_t badFen;
+};
+
+const PgnCase MalformedPgn[] = {
+    { "превращение без поля", "e=Q", 1, 1, 0 },
+    { "превращение без вертикали", "1. 8=Q *", 1, 1, 0 },
+    { "только превращение", "1. =Q *", 1, 1, 0 },
+    { "фигура с вертикалью и превращением", "1. Nf=Q *", 1, 1, 0 },
+    { "фигура без поля", "1. N *", 1, 1, 0 },
+    { "поле за доской", "1. e9 *", 1, 1, 0 },
+    { "незакрытый комментарий", "1. e4 {e5", 1, 0, 0 },
+    { "незакрытый вариант", "1. e4 (1. d4 {d5", 1, 0, 0 },
+    { "тег без конца", "[Event \"x", 1, 0, 0 },
+    { "некорректный FEN", "[FEN \"8/8/8 w - - 0 1\"]\n\n1. e4 *", 1, 0, 1 },
+    { "две партии", "1. e4 e5 *\n\n[Event \"x\"]\n\n1. e4 e4 *", 2, 1, 0 },
+};
+
+int check() {
+    Options options;
+    options.quiet = true;
+    int failures = 0;
+    for (const PgnCase& c : MalformedPgn) {
+        // Текст без завершающего нуля: чтение за его концом заметят санитайзеры
+        vector<char> text(c.pgn, c.pgn + strlen(c.pgn));
+        ShardResult result;
+        analyzePgn(text.data(), 0, text.size(), result, options);
+        bool ok = result.games == c.games && result.illegal == c.illegal && result.badFen == c.badFen;
+        cout << (ok ? "OK      " : "ОШИБКА  ") << c.name << ": партий " << result.games
+             << ", недопустимых " << result.illegal << ", некорректных FEN " << result.badFen
+             << " (ожидается " << c.games << ", " << c.illegal << ", " << c.badFen << ")\n";
+        if (!ok) {
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+void usage() {
+    cout << "Использование:\n"
+         << "  analyze [-t N] [-q] [-o архив] [--pgn | --fen] <файл>\n"
+         << "    -t N   число потоков (по умолчанию - по числу ядер)\n"
+         << "    -q     только сводка, без строк по партиям\n"
+         << "    -o     сохранить допустимые партии в двоичный архив\n"
+         << "  analyze --check   разбор некорректных партий PGN\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int threads = max(1, int(thread::hardware_concurrency()));
+    Options options;
+    string archivePath;
+    int forced = -1;
+    string path;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--check")) {
+            initBitboards();
+            int failures = check();
+            if (failures) {
+                cout << "Есть расхождения: " << failures << "\n";
+            }
+            else {
+                cout << "Все проверки пройдены\n";
+            }
+            return failures ? 1 : 0;
+        }
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-q")) {
+            options.quiet = true;
+        }
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+            archivePath = argv[++i];
+            options.archive = true;
+        }
+        else if (!strcmp(argv[i], "--pgn")) {
+            forced = int(Format::PGN);
+        }
+        else if (!strcmp(argv[i], "--fen")) {
+            forced = int(Format::FEN);
+        }
+        else if (argv[i][0] != '-' && path.empty()) {
+            path = argv[i];
+        }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (path.empty() || threads < 1) {
+        usage();
+        return 1;
+    }
+
+    Format format = Format::PGN;
+    if (forced >= 0) {
+        format = Format(forced);
+    }
+    else {
+        size_t dot = path.rfind('.');
+        string ext = dot == string::npos ? "" : path.substr(dot);
+        if (ext == ".fen" || ext == ".epd") {
+            format = Format::FEN;
+        }
+    }
+
+    MappedFile file;
+    if (!file.open(path)) {
+        cerr << "Не удалось открыть файл: " << path << "\n";
+        return 1;
+    }
+
+    initBitboards();   // Таблицы атак строятся до замера времени
+
+    auto start = chrono::steady_clock::now();
+    const char* data = file.data();
+    size_t size = file.size();
+
+    // Архив открывается заранее: записи частей дописываются по мере готовности
+    ArchiveWriter writer;
+    if (options.archive && !writer.open(archivePath)) {
+        cerr << "Не удалось записать архив: " << archivePath << "\n";
+        return 1;
+    }
+
+    // Границы частей сдвигаются вперед до начала ближайшей партии (строки)
+    size_t shardCount = max(size_t(threads) * SHARDS_PER_THREAD, size / SHARD_BYTES + 1);
+    vector<size_t> bounds;
+    bounds.push_back(0);
+    for (size_t i = 1; i < shardCount; ++i) {
+        size_t pos = size / shardCount * i;
+        pos = format == Format::PGN ? findGameStart(data, size, pos) : findLineStart(data, size, pos);
+        bounds.push_back(max(pos, bounds.back()));
+    }
+    bounds.push_back(size);
+
+    // Готовые части выводятся строго в порядке файла: поток, закончивший часть,
+    // выводит все готовые части подряд, начиная с nextEmit. Часть s берется, только
+    // когда s < nextEmit + window, и занимает ячейку s % window
+    size_t window = size_t(threads) * SHARDS_IN_FLIGHT;
+    vector<ShardResult> slots(window);
+    vector<char> done(window, 0);
+    mutex lockMutex;
+    condition_variable slotFreed;
+    size_t nextShard = 0;
+    size_t nextEmit = 0;
+    ShardResult total;
+
+    auto work = [&] {
+        unique_lock<mutex> lock(lockMutex);
+        for (;;) {
+            slotFreed.wait(lock, [&] {
+                return nextShard >= shardCount || nextShard < nextEmit + window;
+            });
+            if (nextShard >= shardCount) {
+                break;
+            }
+            size_t s = nextShard++;
+            ShardResult& result = slots[s % window];
+            lock.unlock();
+            if (format == Format::PGN) {
+                analyzePgn(data, bounds[s], bounds[s + 1], result, options);
+            }
+            else {
+                analyzeFen(data, bounds[s], bounds[s + 1], result, options);
+            }
+            lock.lock();
+
+            done[s % window] = 1;
+            bool emitted = false;
+            while (nextEmit < shardCount && done[nextEmit % window]) {
+                ShardResult& ready = slots[nextEmit % window];
+                cout << ready.output;
+                if (options.archive) {
+                    writer.addEncoded(ready.archive);
+                }
+                total.merge(ready);
+                ready.reset();
+                done[nextEmit % window] = 0;
+                ++nextEmit;
+                emitted = true;
+            }
+            if (emitted) {
+                slotFreed.notify_all();
+            }
+        }
+    };
+
+    vector<thread> workers;
+    for (int i = 1; i < threads; ++i) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (thread& t : workers) {
+        t.join();
+    }
+    cout.flush();
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cerr << (format == Format::PGN ? "Партий: " : "Позиций: ") << total.games
+         << ", полуходов: " << total.plies
+         << ", недопустимых ходов: " << total.illegal
+         << ", некорректных FEN: " << total.badFen
+         << ", матов: " << total.mates
+         << ", патов: " << total.stalemates
+         << ", ничьих по правилам: " << total.ruleDraws << "\n"
+         << fixed << setprecision(3) << seconds << " с, " << threads << " потоков, "
+         << setprecision(0) << (seconds > 0 ? total.games / seconds : 0.0) << " партий/с, "
+         << setprecision(1) << (seconds > 0 ? size / seconds / 1e6 : 0.0) << " МБ/с\n";
+
+    // Индекс архива записывается после всех партий
+    if (options.archive) {
+        uint64_t archived = writer.gameCount();
+        if (!writer.close()) {
+            cerr << "Не удалось записать архив: " << archivePath << "\n";
+            return 1;
+        }
+        cerr << "Архив " << archivePath << ": " << archived << " партий";
+        if (total.unpackable) {
+            cerr << ", пропущено (больше 32 фигур): " << total.unpackable;
+        }
+        cerr << "\n";
+    }
+    return 0;
+}
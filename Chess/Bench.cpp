@@ -0,0 +1,488 @@
+// Замеры скорости движка.
+//
+//   bench smp [-d N] [-t N] [-s MB]   - масштабирование перебора Lazy SMP:
+//                                      время до глубины N и скорость при 1, 2, 4, 8...
+//                                      потоках (до -t или числа ядер)
+//   bench eval [-n N]                 - скорость статической оценки на наборе позиций
+//                                      (N проходов), сверка инкрементальных таблиц
+//   bench pawns [-d N]                - перебор пешечных позиций до глубины N
+//                                      с пешечным хешем и без него (лучшее из 3 запусков)
+//   bench mate [-g N] [-n N]          - скорость определения шаха, мата и пата на
+//                                      позициях из N случайных партий каждого уровня
+//                                      сложности: полный пересчет против кэша доски
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ChessBoard.h"
+#include "Evaluate.h"
+#include "SearchPool.h"
+
+using namespace std;
+
+namespace {
+
+// Позиции для замеров: начало партии и несколько миттельшпилей
+const char* BenchPositions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP3PPP/R2QKB1R w KQ - 0 8",
+    "2r3k1/pp3ppp/2n1b3/3p4/3P4/2PB1N2/P4PPP/R5K1 w - - 0 20",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+};
+
+// Пешечные позиции: начало партии на уровне 2 и эндшпили
+const char* PawnPositions[] = {
+    "4k3/pppppppp/8/8/8/8/PPPPPPPP/4K3 w - - 0 1",
+    "8/pp3k2/2p1p1p1/3pP1P1/3P1P2/2P5/PP2K3/8 w - - 0 1",
+    "8/8/1p2k1p1/p1p2p1p/P1P2P1P/1P2K1P1/8/8 w - - 0 1",
+    "8/k7/3p4/p2P1p2/P2P1P2/8/8/K7 w - - 0 1",
+    "8/5pk1/6p1/7p/7P/6P1/5PK1/8 w - - 0 1",
+};
+
+struct SmpRun {
+    uint64_t nodes = 0;
+    int64_t timeMs = 0;
+};
+
+// Перебор всех позиций до заданной глубины с чистой хеш-таблицей
+SmpRun runPositions(SearchPool& pool, int depth) {
+    SmpRun total;
+    for (const char* fen : BenchPositions) {
+        ChessBoard board;
+        board.loadFen(fen);
+        pool.clear();
+
+        SearchLimits limits;
+        limits.depth = depth;
+        SearchResult result = pool.run(board, limits);
+        total.nodes += result.nodes;
+        total.timeMs += result.timeMs;
+    }
+    return total;
+}
+
+int benchSmp(int depth, int maxThreads, size_t hashMb) {
+    TranspositionTable table(hashMb);
+
+    vector<int> counts;
+    for (int n = 1; n <= maxThreads; n *= 2) {
+        counts.push_back(n);
+    }
+    if (counts.back() != maxThreads) {
+        counts.push_back(maxThreads);
+    }
+
+    cout << "Lazy SMP: " << sizeof(BenchPositions) / sizeof(BenchPositions[0]) << " позиций, глубина " << depth
+         << ", хеш " << hashMb << " МБ\n";
+    cout << "потоки      время, мс          узлы   тыс. узлов/с   ускорение\n";
+
+    int64_t baseTime = 0;
+    for (int n : counts) {
+        SearchPool pool(&table, n);
+        SmpRun run = runPositions(pool, depth);
+        if (n == 1) {
+            baseTime = run.timeMs;
+        }
+        uint64_t nps = run.timeMs > 0 ? run.nodes * 1000 / uint64_t(run.timeMs) : 0;
+        cout << setw(6) << n
+             << setw(15) << run.timeMs
+             << setw(14) << run.nodes
+             << setw(15) << nps / 1000
+             << setw(12) << fixed << setprecision(2)
+             << (run.timeMs > 0 ? double(baseTime) / double(run.timeMs) : 0.0) << "\n";
+    }
+    return 0;
+}
+
+// Набор для оценки: позиции замеров и все позиции на два полухода от них
+vector<ChessBoard> evalSuite() {
+    vector<ChessBoard> suite;
+    for (const char* fen : BenchPositions) {
+        ChessBoard board;
+        board.loadFen(fen);
+        suite.push_back(board);
+
+        MoveList first;
+        board.generateMoves(first);
+        for (Move m1 : first) {
+            board.makeMove(m1);
+            suite.push_back(board);
+            MoveList second;
+            board.generateMoves(second);
+            for (Move m2 : second) {
+                board.makeMove(m2);
+                suite.push_back(board);
+                board.unmakeMove();
+            }
+            board.unmakeMove();
+        }
+    }
+    return suite;
+}
+
+// Скорость прохода func по всему набору iterations раз, оценок в секунду
+template <typename Func>
+double evalRate(const vector<ChessBoard>& suite, int iterations, int64_t& checksum, Func func) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        for (const ChessBoard& board : suite) {
+            checksum += func(board);
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return seconds > 0 ? double(suite.size()) * iterations / seconds : 0.0;
+}
+
+int benchEval(int iterations) {
+    vector<ChessBoard> suite = evalSuite();
+
+    // Инкрементальные счетчики доски должны совпадать с полным пересчетом
+    int mismatches = 0;
+    for (const ChessBoard& board : suite) {
+        PsqScore full = computePsq(board);
+        if (full.mg != board.psqMidgame() || full.eg != board.psqEndgame()) {
+            ++mismatches;
+        }
+    }
+
+    int64_t checksum = 0;
+    double full = evalRate(suite, iterations, checksum, [](const ChessBoard& b) {
+        return evaluate(b);
+    });
+    double recomputed = evalRate(suite, iterations, checksum, [](const ChessBoard& b) {
+        PsqScore s = computePsq(b);
+        return s.mg + s.eg;
+    });
+
+    cout << "Оценка: " << suite.size() << " позиций, " << iterations << " проходов\n"
+         << fixed << setprecision(2)
+         << "  полная оценка:                      " << full / 1e6 << " млн/с\n"
+         << "  полный пересчет материала и таблиц: " << recomputed / 1e6 << " млн/с\n"
+         << "  расхождений с пересчетом: " << mismatches << " (контрольная сумма " << checksum << ")\n";
+    return mismatches ? 1 : 0;
+}
+
+struct PawnRun {
+    uint64_t nodes = 0;
+    int64_t timeMs = 0;
+    TTStats pawns;
+};
+
+// Перебор пешечных позиций одним потоком с чистыми таблицами
+PawnRun runPawnPositions(Search& search, TranspositionTable& table, int depth) {
+    PawnRun total;
+    for (const char* fen : PawnPositions) {
+        ChessBoard board;
+        board.loadFen(fen);
+        table.clear();
+        search.clear();
+
+        SearchLimits limits;
+        limits.depth = depth;
+        SearchResult result = search.run(board, limits);
+        total.nodes += result.nodes;
+        total.timeMs += result.timeMs;
+        total.pawns.merge(search.pawnStats());
+    }
+    return total;
+}
+
+int benchPawns(int depth) {
+    TranspositionTable table(64);
+    Search search(&table);
+
+    cout << "Пешечный хеш: " << sizeof(PawnPositions) / sizeof(PawnPositions[0])
+         << " позиций, глубина " << depth << "\n";
+    cout << "таблица         время, мс          узлы   тыс. узлов/с   попадания\n";
+
+    // Запуски чередуются, чтобы фоновая нагрузка одинаково влияла на оба варианта
+    const int RUNS = 3;
+    PawnRun best[2];
+    for (int i = 0; i < RUNS; ++i) {
+        for (int enabled = 0; enabled < 2; ++enabled) {
+            search.resizePawnTable(enabled ? PawnTable::DEFAULT_ENTRIES : 0);
+            PawnRun run = runPawnPositions(search, table, depth);
+            if (i == 0 || run.timeMs < best[enabled].timeMs) {
+                best[enabled] = run;
+            }
+        }
+    }
+
+    for (int enabled = 0; enabled < 2; ++enabled) {
+        const PawnRun& run = best[enabled];
+        uint64_t nps = run.timeMs > 0 ? run.nodes * 1000 / uint64_t(run.timeMs) : 0;
+        cout << left << setw(10) << (enabled ? "есть" : "нет") << right
+             << setw(15) << run.timeMs
+             << setw(14) << run.nodes
+             << setw(15) << nps / 1000
+             << setw(11) << fixed << setprecision(1) << run.pawns.hitRate() * 100 << "%\n";
+    }
+    cout << "ускорение: " << setprecision(2)
+         << (best[1].timeMs > 0 ? double(best[0].timeMs) / double(best[1].timeMs) : 0.0) << "\n";
+    return 0;
+}
+
+// Случайная партия из начальной расстановки: доска стоит в начальной позиции,
+// ходы проигрываются заново при каждом замере
+struct MateGame {
+    ChessBoard board;
+    vector<Move> moves;
+
+    explicit MateGame(int difficulty) : board(difficulty) {
+    }
+};
+
+// Случайные партии уровня difficulty. Если есть матующий ход, он делается,
+// поэтому партии часто заканчиваются матом
+vector<MateGame> mateSuite(int difficulty, int games, int& mates, size_t& positions) {
+    const int MAX_PLIES = 200;
+    mt19937 rng(static_cast<uint32_t>(difficulty));
+    vector<MateGame> suite;
+    mates = 0;
+    positions = 0;
+    for (int g = 0; g < games; ++g) {
+        MateGame game(difficulty);
+        ChessBoard& board = game.board;
+        for (int ply = 0; ply < MAX_PLIES; ++ply) {
+            MoveList list;
+            board.generateMoves(list);
+            if (list.empty()) {
+                mates += board.isInCheck(board.sideToMove()) ? 1 : 0;
+                break;
+            }
+            Move chosen = list[int(rng() % uint32_t(list.size()))];
+            for (Move move : list) {
+                board.makeMove(move);
+                bool mate = board.isCheckmate(board.sideToMove());
+                board.unmakeMove();
+                if (mate) {
+                    chosen = move;
+                    break;
+                }
+            }
+            board.makeMove(chosen);
+            game.moves.push_back(chosen);
+        }
+        positions += game.moves.size() + 1;
+        for (size_t i = 0; i < game.moves.size(); ++i) {
+            board.unmakeMove();
+        }
+        suite.push_back(move(game));
+    }
+    return suite;
+}
+
+// Проигрывание партий iterations раз с вызовом func в каждой позиции, включая
+// начальную; время прохода, с. Позиция опрашивается сразу после makeMove (или
+// unmakeMove для начальной), то есть с пустым кэшем доски - как в игре
+template <typename Func>
+double replaySeconds(vector<MateGame>& suite, int iterations, int64_t& checksum, Func func) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        for (MateGame& game : suite) {
+            ChessBoard& board = game.board;
+            checksum += func(board);
+            for (Move move : game.moves) {
+                board.makeMove(move);
+                checksum += func(board);
+            }
+            for (size_t k = 0; k < game.moves.size(); ++k) {
+                board.unmakeMove();
+            }
+        }
+    }
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Шах, найденный полным пересчетом атак на короля текущего игрока
+bool recomputedCheck(const ChessBoard& b) {
+    Color us = b.sideToMove();
+    Color them = us == Color::WHITE ? Color::BLACK : Color::WHITE;
+    Bitboard king = b.piecesOf(us, PieceType::KING);
+    if (!king) {
+        return false;
+    }
+    int sq = lsb(king);
+    Bitboard queens = b.piecesOf(them, PieceType::QUEEN);
+    return (PawnAttacks.sq[us == Color::WHITE ? 0 : 1][sq] & b.piecesOf(them, PieceType::PAWN))
+        || (KnightAttacks.sq[sq] & b.piecesOf(them, PieceType::KNIGHT))
+        || (KingAttacks.sq[sq] & b.piecesOf(them, PieceType::KING))
+        || (rookAttacks(sq, b.occupied()) & (b.piecesOf(them, PieceType::ROOK) | queens))
+        || (bishopAttacks(sq, b.occupied()) & (b.piecesOf(them, PieceType::BISHOP) | queens));
+}
+
+// Конец партии без кэша доски: пересчет шаха и полный список допустимых ходов;
+// 2 - мат, 1 - пат, 0 - ходы есть
+int recomputedEnding(const ChessBoard& b) {
+    bool check = recomputedCheck(b);
+    MoveList list;
+    b.generateMoves(list);
+    return list.empty() ? (check ? 2 : 1) : 0;
+}
+
+// То же через кэш доски и поиск до первого хода
+int cachedEnding(const ChessBoard& b) {
+    Color side = b.sideToMove();
+    return b.isCheckmate(side) ? 2 : b.isStalemate(side) ? 1 : 0;
+}
+
+int benchMate(int games, int iterations) {
+    cout << "Шах и мат: " << games << " случайных партий на уровень, " << iterations << " проходов, нс на позицию\n"
+         << "(сверх makeMove/unmakeMove; кэш доски перед каждым опросом пуст)\n"
+         << "уровень   позиций  матов   шах: пересчет      кэш   мат/пат: список ходов   ранний выход   ускорение\n";
+
+    int mismatches = 0;
+    int64_t checksum = 0;
+    for (int difficulty = 1; difficulty <= 3; ++difficulty) {
+        int mates = 0;
+        size_t positions = 0;
+        vector<MateGame> suite = mateSuite(difficulty, games, mates, positions);
+
+        // Кэш доски должен давать те же ответы, что и пересчет
+        replaySeconds(suite, 1, checksum, [&](const ChessBoard& b) {
+            bool check = b.isInCheck(b.sideToMove());
+            if (check != recomputedCheck(b) || cachedEnding(b) != recomputedEnding(b)) {
+                ++mismatches;
+            }
+            return 0;
+        });
+
+        // Из каждого замера вычитается проход только с ходами
+        double base = replaySeconds(suite, iterations, checksum, [](const ChessBoard&) {
+            return 0;
+        });
+        auto ns = [&](double seconds) {
+            return max(0.0, seconds - base) * 1e9 / (double(positions) * iterations);
+        };
+        double checkFull = ns(replaySeconds(suite, iterations, checksum, [](const ChessBoard& b) {
+            return recomputedCheck(b) ? 1 : 0;
+        }));
+        double checkCached = ns(replaySeconds(suite, iterations, checksum, [](const ChessBoard& b) {
+            return b.isInCheck(b.sideToMove()) ? 1 : 0;
+        }));
+        double mateFull = ns(replaySeconds(suite, iterations, checksum, recomputedEnding));
+        double mateCached = ns(replaySeconds(suite, iterations, checksum, cachedEnding));
+
+        cout << fixed << setprecision(1)
+             << setw(7) << difficulty
+             << setw(10) << positions
+             << setw(7) << mates
+             << setw(17) << checkFull
+             << setw(9) << checkCached
+             << setw(24) << mateFull
+             << setw(15) << mateCached
+             << setw(12) << setprecision(2) << (mateCached > 0 ? mateFull / mateCached : 0.0) << "\n";
+    }
+    cout << "расхождений с пересчетом: " << mismatches << " (контрольная сумма " << checksum << ")\n";
+    return mismatches ? 1 : 0;
+}
+
+void usage() {
+    cout << "Использование:\n"
+         << "  bench smp [-d N] [-t N] [-s MB]\n"
+         << "  bench eval [-n N]\n"
+         << "  bench pawns [-d N]\n"
+         << "  bench mate [-g N] [-n N]\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc >= 2 && !strcmp(argv[1], "eval")) {
+        int iterations = 200;
+        for (int i = 2; i < argc; ++i) {
+            if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+                iterations = atoi(argv[++i]);
+            }
+            else {
+                usage();
+                return 1;
+            }
+        }
+        if (iterations < 1) {
+            usage();
+            return 1;
+        }
+        return benchEval(iterations);
+    }
+
+    if (argc >= 2 && !strcmp(argv[1], "pawns")) {
+        int depth = 11;
+        for (int i = 2; i < argc; ++i) {
+            if (!strcmp(argv[i], "-d") && i + 1 < argc) {
+                depth = atoi(argv[++i]);
+            }
+            else {
+                usage();
+                return 1;
+            }
+        }
+        if (depth < 1) {
+            usage();
+            return 1;
+        }
+        return benchPawns(depth);
+    }
+
+    if (argc >= 2 && !strcmp(argv[1], "mate")) {
+        int games = 20;
+        int iterations = 100;
+        for (int i = 2; i < argc; ++i) {
+            if (!strcmp(argv[i], "-g") && i + 1 < argc) {
+                games = atoi(argv[++i]);
+            }
+            else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+                iterations = atoi(argv[++i]);
+            }
+            else {
+                usage();
+                return 1;
+            }
+        }
+        if (games < 1 || iterations < 1) {
+            usage();
+            return 1;
+        }
+        return benchMate(games, iterations);
+    }
+
+    if (argc < 2 || strcmp(argv[1], "smp")) {
+        usage();
+        return 1;
+    }
+
+    int depth = 8;
+    int maxThreads = max(1, int(thread::hardware_concurrency()));
+    size_t hashMb = 64;
+
+    for (int i = 2; i < argc; ++i) {
+        if (!strcmp(argv[i], "-d") && i + 1 < argc) {
+            depth = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+            maxThreads = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            hashMb = size_t(atoi(argv[++i]));
+        }
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    if (depth < 1 || maxThreads < 1 || hashMb < 1) {
+        usage();
+        return 1;
+    }
+    return benchSmp(depth, maxThreads, hashMb);
+}
@@ -0,0 +1,142 @@
+#include "Bitboard.h"
+
+Magic RookMagics[64];
+Magic BishopMagics[64];
+Bitboard BetweenBB[64][64];
+Bitboard LineBB[64][64];
+
+namespace {
+
+// Общие таблицы атак: 102400 вариантов для ладьи и 5248 для слона
+Bitboard RookTable[0x19000];
+Bitboard BishopTable[0x1480];
+
+// Простой генератор псевдослучайных чисел (xorshift64*), детерминированный
+class Prng {
+    uint64_t s;
+public:
+    explicit Prng(uint64_t seed) : s(seed) {}
+
+    uint64_t next() {
+        s ^= s >> 12;
+        s ^= s << 25;
+        s ^= s >> 27;
+        return s * 2685821657736338717ULL;
+    }
+
+    // Число с малым количеством единичных битов - хороший кандидат в магию
+    uint64_t sparse() { return next() & next() & next(); }
+};
+
+// Атаки луча "в лоб": идем по направлениям до первой занятой клетки
+Bitboard slidingAttacks(const int (*dirs)[2], int sq, Bitboard occupied) {
+    Bitboard result = 0;
+    for (int d = 0; d < 4; ++d) {
+        int x = fileOf(sq) + dirs[d][0];
+        int y = rankOf(sq) + dirs[d][1];
+        while (x >= 0 && x < 8 && y >= 0 && y < 8) {
+            Bitboard b = squareBB(makeSquare(x, y));
+            result |= b;
+            if (occupied & b) {
+                break;
+            }
+            x += dirs[d][0];
+            y += dirs[d][1];
+        }
+    }
+    return result;
+}
+
+// Подбор магических чисел для всех клеток (как в "fancy magic bitboards")
+void initMagics(const int (*dirs)[2], Bitboard* table, Magic* magics) {
+    Bitboard reference[4096];
+#if !defined(USE_PEXT)
+    Bitboard occupancy[4096];
+    // Зерна подобраны так, чтобы поиск завершался быстро
+    const uint64_t seeds[8] = { 728, 10316, 55013, 32803, 12281, 15100, 16645, 255 };
+    int epoch[4096] = {};
+    int attempt = 0;
+#endif
+
+    Bitboard* next = table;
+    for (int sq = 0; sq < 64; ++sq) {
+        Magic& m = magics[sq];
+
+        // Края доски не влияют на атаки, если фигура не стоит на этом краю
+        Bitboard edges = ((RANK_1_BB | RANK_8_BB) & ~(RANK_1_BB << (8 * rankOf(sq))))
+                       | ((FILE_A_BB | FILE_H_BB) & ~(FILE_A_BB << fileOf(sq)));
+        m.mask = slidingAttacks(dirs, sq, 0) & ~edges;
+        m.shift = 64 - popCount(m.mask);
+        m.attacks = next;
+
+        // Перебираем все подмножества маски (carry-rippler)
+        int size = 0;
+        Bitboard b = 0;
+        do {
+            reference[size] = slidingAttacks(dirs, sq, b);
+#if defined(USE_PEXT)
+            m.attacks[_pext_u64(b, m.mask)] = reference[size];
+#else
+            occupancy[size] = b;
+#endif
+            ++size;
+            b = (b - m.mask) & m.mask;
+        } while (b);
+        next += size;
+
+#if !defined(USE_PEXT)
+        Prng rng(seeds[rankOf(sq)]);
+        for (int i = 0; i < size; ) {
+            do {
+                m.magic = rng.sparse();
+            } while (popCount((m.magic * m.mask) >> 56) < 6);
+
+            // Проверяем, что магия не дает разрушительных коллизий
+            ++attempt;
+            for (i = 0; i < size; ++i) {
+                unsigned idx = m.index(occupancy[i]);
+                if (epoch[idx] < attempt) {
+                    epoch[idx] = attempt;
+                    m.attacks[idx] = reference[i];
+                }
+                else if (m.attacks[idx] != reference[i]) {
+                    break;
+                }
+            }
+        }
+#endif
+    }
+}
+
+void initAll() {
+    const int rookDirs[4][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+    const int bishopDirs[4][2] = { {1, 1}, {1, -1}, {-1, 1}, {-1, -1} };
+    initMagics(rookDirs, RookTable, RookMagics);
+    initMagics(bishopDirs, BishopTable, BishopMagics);
+
+    // Таблицы линий и промежутков для связок и закрытия от шаха
+    for (int a = 0; a < 64; ++a) {
+        for (int b = 0; b < 64; ++b) {
+            BetweenBB[a][b] = LineBB[a][b] = 0;
+            if (a == b) {
+                continue;
+            }
+            if (rookAttacks(a, 0) & squareBB(b)) {
+                LineBB[a][b] = (rookAttacks(a, 0) & rookAttacks(b, 0)) | squareBB(a) | squareBB(b);
+                BetweenBB[a][b] = rookAttacks(a, squareBB(b)) & rookAttacks(b, squareBB(a));
+            }
+            else if (bishopAttacks(a, 0) & squareBB(b)) {
+                LineBB[a][b] = (bishopAttacks(a, 0) & bishopAttacks(b, 0)) | squareBB(a) | squareBB(b);
+                BetweenBB[a][b] = bishopAttacks(a, squareBB(b)) & bishopAttacks(b, squareBB(a));
+            }
+        }
+    }
+}
+
+} // namespace
+
+void initBitboards() {
+    // Статическая локальная переменная гарантирует однократную потокобезопасную инициализацию
+    static const bool initialized = (initAll(), true);
+    (void)initialized;
+}
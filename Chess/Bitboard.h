@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(USE_PEXT)
+#include <immintrin.h>
+#endif
+
+// Битборд: один бит на каждую из 64 клеток (бит 0 = a1, бит 7 = h1, бит 63 = h8)
+typedef uint64_t Bitboard;
+
+// Номер клетки 0-63: x + 8 * y
+inline constexpr int makeSquare(int x, int y) { return x + 8 * y; }
+inline constexpr int fileOf(int sq) { return sq & 7; }
+inline constexpr int rankOf(int sq) { return sq >> 3; }
+inline constexpr Bitboard squareBB(int sq) { return Bitboard(1) << sq; }
+
+const Bitboard FILE_A_BB = 0x0101010101010101ULL;
+const Bitboard FILE_H_BB = FILE_A_BB << 7;
+const Bitboard RANK_1_BB = 0xFFULL;
+const Bitboard RANK_8_BB = RANK_1_BB << 56;
+const Bitboard DARK_SQUARES_BB = 0xAA55AA55AA55AA55ULL;
+
+// Количество установленных битов
+inline int popCount(Bitboard b) {
+#if defined(_MSC_VER) && defined(_WIN64)
+    return int(__popcnt64(b));
+#elif defined(_MSC_VER)
+    return int(__popcnt(unsigned(b)) + __popcnt(unsigned(b >> 32)));
+#else
+    return __builtin_popcountll(b);
+#endif
+}
+
+// Номер младшего установленного бита (b не должен быть нулевым)
+inline int lsb(Bitboard b) {
+#if defined(_MSC_VER) && defined(_WIN64)
+    unsigned long idx;
+    _BitScanForward64(&idx, b);
+    return int(idx);
+#elif defined(_MSC_VER)
+    unsigned long idx;
+    if (unsigned(b)) {
+        _BitScanForward(&idx, unsigned(b));
+        return int(idx);
+    }
+    _BitScanForward(&idx, unsigned(b >> 32));
+    return int(idx + 32);
+#else
+    return __builtin_ctzll(b);
+#endif
+}
+
+// Извлекает младший бит и сбрасывает его в b
+inline int popLsb(Bitboard& b) {
+    int sq = lsb(b);
+    b &= b - 1;
+    return sq;
+}
+
+inline bool moreThanOne(Bitboard b) { return (b & (b - 1)) != 0; }
+
+// Таблица атак: по битборду на каждую клетку
+struct AttackTable {
+    Bitboard sq[64];
+};
+
+struct PawnAttackTable {
+    Bitboard sq[2][64]; // [0] - белые, [1] - черные
+};
+
+// Битборд клеток, на которые можно попасть сдвигами (dx, dy) из клетки sq
+inline constexpr Bitboard stepAttacks(int sq, const int (*steps)[2], int count) {
+    Bitboard result = 0;
+    for (int i = 0; i < count; ++i) {
+        int x = fileOf(sq) + steps[i][0];
+        int y = rankOf(sq) + steps[i][1];
+        if (x >= 0 && x < 8 && y >= 0 && y < 8) {
+            result |= squareBB(makeSquare(x, y));
+        }
+    }
+    return result;
+}
+
+inline constexpr AttackTable makeKnightAttacks() {
+    const int steps[8][2] = { {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2} };
+    AttackTable t{};
+    for (int sq = 0; sq < 64; ++sq) {
+        t.sq[sq] = stepAttacks(sq, steps, 8);
+    }
+    return t;
+}
+
+inline constexpr AttackTable makeKingAttacks() {
+    const int steps[8][2] = { {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1} };
+    AttackTable t{};
+    for (int sq = 0; sq < 64; ++sq) {
+        t.sq[sq] = stepAttacks(sq, steps, 8);
+    }
+    return t;
+}
+
+inline constexpr PawnAttackTable makePawnAttacks() {
+    const int white[2][2] = { {-1, 1}, {1, 1} };
+    const int black[2][2] = { {-1, -1}, {1, -1} };
+    PawnAttackTable t{};
+    for (int sq = 0; sq < 64; ++sq) {
+        t.sq[0][sq] = stepAttacks(sq, white, 2);
+        t.sq[1][sq] = stepAttacks(sq, black, 2);
+    }
+    return t;
+}
+
+// Атаки коня, короля и пешек считаются на этапе компиляции
+inline constexpr AttackTable KnightAttacks = makeKnightAttacks();
+inline constexpr AttackTable KingAttacks = makeKingAttacks();
+inline constexpr PawnAttackTable PawnAttacks = makePawnAttacks();
+
+// Магическая таблица атак дальнобойной фигуры для одной клетки
+struct Magic {
+    Bitboard mask = 0;        // Значимые клетки (без краев доски)
+    Bitboard magic = 0;       // Магическое число
+    Bitboard* attacks = nullptr; // Начало блока атак этой клетки в общей таблице
+    unsigned shift = 0;       // 64 - число значимых клеток
+
+    unsigned index(Bitboard occupied) const {
+#if defined(USE_PEXT)
+        return unsigned(_pext_u64(occupied, mask));
+#else
+        return unsigned(((occupied & mask) * magic) >> shift);
+#endif
+    }
+};
+
+extern Magic RookMagics[64];
+extern Magic BishopMagics[64];
+
+// Клетки строго между a и b, если они на одной линии (иначе 0)
+extern Bitboard BetweenBB[64][64];
+// Вся линия (горизонталь, вертикаль или диагональ) через a и b, если она есть
+extern Bitboard LineBB[64][64];
+
+// Построение магических таблиц. Можно вызывать повторно и из разных потоков
+void initBitboards();
+
+inline Bitboard rookAttacks(int sq, Bitboard occupied) {
+    const Magic& m = RookMagics[sq];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard bishopAttacks(int sq, Bitboard occupied) {
+    const Magic& m = BishopMagics[sq];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard queenAttacks(int sq, Bitboard occupied) {
+    return rookAttacks(sq, occupied) | bishopAttacks(sq, occupied);
+}
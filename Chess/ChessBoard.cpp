@@ -0,0 +1,1139 @@
+#include "ChessBoard.h"
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+#include "Profile.h"
+#include "Zobrist.h"
+
+// CHESS_DEBUG_HASH: после каждого хода ключи Зобриста (полный и пешечный) пересчитываются
+// с нуля и сверяются. Проверка не зависит от NDEBUG: при расхождении программа
+// сообщает ключи и позицию и завершается через abort()
+#if defined(CHESS_DEBUG_HASH)
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+[[noreturn]] void hashMismatch(const char* where, uint64_t key, uint64_t expectedKey,
+                               uint64_t pawnKey, uint64_t expectedPawnKey, const std::string& fen) {
+    std::fprintf(stderr, "%s: ключ %016" PRIx64 " (пересчет %016" PRIx64 "), ключ пешек %016" PRIx64
+                 " (пересчет %016" PRIx64 "), позиция %s\n",
+                 where, key, expectedKey, pawnKey, expectedPawnKey, fen.c_str());
+    std::abort();
+}
+
+} // namespace
+
+#define VERIFY_HASH()                                                                      \
+    do {                                                                                   \
+        if (key != computeKey() || pawnKey != computePawnKey()) {                          \
+            hashMismatch(__func__, key, computeKey(), pawnKey, computePawnKey(), toFen()); \
+        }                                                                                  \
+    } while (0)
+#else
+#define VERIFY_HASH() ((void)0)
+#endif
+
+namespace {
+
+// Добавление в список ходов с клетки from на все клетки targets
+void addMoves(MoveList& list, int from, Bitboard targets) {
+    while (targets) {
+        list.add(encodeMove(from, popLsb(targets)));
+    }
+}
+
+// Добавление ходов пешек по сдвинутому битборду (delta - смещение "куда" - "откуда")
+void addPawnMoves(MoveList& list, Bitboard targets, int delta) {
+    while (targets) {
+        int to = popLsb(targets);
+        list.add(encodeMove(to - delta, to));
+    }
+}
+
+// Превращение пешки: по ходу на каждую фигуру, ферзь первым
+void addPromotions(MoveList& list, int from, int to) {
+    for (int piece = 3; piece >= 0; --piece) {
+        list.add(encodeMove(from, to, MOVE_PROMOTION, piece));
+    }
+}
+
+void addPawnPromotions(MoveList& list, Bitboard targets, int delta) {
+    while (targets) {
+        int to = popLsb(targets);
+        addPromotions(list, to - delta, to);
+    }
+}
+
+} // namespace
+
+std::string squareName(int sq) {
+    std::string name;
+    name += char('a' + fileOf(sq));
+    name += char('1' + rankOf(sq));
+    return name;
+}
+
+int parseSquare(const std::string& name) {
+    if (name.length() != 2) {
+        return -1;
+    }
+    int x = tolower(name[0]) - 'a';
+    int y = name[1] - '1';
+    if (x < 0 || x > 7 || y < 0 || y > 7) {
+        return -1;
+    }
+    return makeSquare(x, y);
+}
+
+std::string moveToString(Move move) {
+    std::string text = squareName(moveFrom(move)) + squareName(moveTo(move));
+    if (moveType(move) == MOVE_PROMOTION) {
+        text += "nbrq"[movePromotion(move)];
+    }
+    return text;
+}
+
+ChessBoard::ChessBoard(int diff) : difficulty(diff) {
+    history.reserve(HISTORY_RESERVE);
+    initBitboards();
+    initializeBoard();
+}
+
+// Права на рокировку (биты KQkq), выводятся из Piece::hasMoved короля и ладей
+int ChessBoard::castlingRights() const {
+    static const int kingSq[2] = { makeSquare(4, 0), makeSquare(4, 7) };
+    int rights = 0;
+    for (int c = 0; c < 2; ++c) {
+        if (!(unmovedBB & pieces[c][int(PieceType::KING)] & squareBB(kingSq[c]))) {
+            continue;
+        }
+        Bitboard rooks = unmovedBB & pieces[c][int(PieceType::ROOK)];
+        if (rooks & squareBB(kingSq[c] + 3)) {
+            rights |= 1 << (2 * c);     // Короткая рокировка
+        }
+        if (rooks & squareBB(kingSq[c] - 4)) {
+            rights |= 2 << (2 * c);     // Длинная рокировка
+        }
+    }
+    return rights;
+}
+
+// Клетка взятия на проходе, если рядом с прошедшей пешкой есть пешка соперника
+int ChessBoard::enPassantTarget() const {
+    if (epSquare < 0) {
+        return -1;
+    }
+    int us = colorIndex(currentPlayer);
+    return (PawnAttacks.sq[us ^ 1][epSquare] & pieces[us][int(PieceType::PAWN)]) ? epSquare : -1;
+}
+
+// Вклад взятия на проходе в ключ: учитывается, только если пешке есть чем взять
+uint64_t ChessBoard::enPassantKey() const {
+    int sq = enPassantTarget();
+    return sq >= 0 ? Zobrist.enPassant[fileOf(sq)] : 0;
+}
+
+// Полный пересчет ключа Зобриста
+uint64_t ChessBoard::computeKey() const {
+    uint64_t k = 0;
+    for (int c = 0; c < 2; ++c) {
+        for (int t = 0; t < 6; ++t) {
+            Bitboard b = pieces[c][t];
+            while (b) {
+                k ^= Zobrist.piece[c][t][popLsb(b)];
+            }
+        }
+    }
+    if (currentPlayer == Color::BLACK) {
+        k ^= Zobrist.side;
+    }
+    return k ^ Zobrist.castling[castlingRights()] ^ enPassantKey();
+}
+
+uint64_t ChessBoard::computePawnKey() const {
+    uint64_t k = 0;
+    for (int c = 0; c < 2; ++c) {
+        Bitboard b = pieces[c][int(PieceType::PAWN)];
+        while (b) {
+            k ^= Zobrist.piece[c][int(PieceType::PAWN)][popLsb(b)];
+        }
+    }
+    return k;
+}
+
+// Клетки, куда может пойти фигура с клетки sq (без учета шаха своему королю)
+Bitboard ChessBoard::pseudoTargets(int sq) const {
+    int us = (colorBB[0] & squareBB(sq)) ? 0 : 1;
+    Bitboard own = colorBB[us];
+
+    switch (mailbox[sq]) {
+    case PieceType::KING:
+        return KingAttacks.sq[sq] & ~own;
+    case PieceType::QUEEN:
+        return queenAttacks(sq, occupiedBB) & ~own;
+    case PieceType::ROOK:
+        return rookAttacks(sq, occupiedBB) & ~own;
+    case PieceType::BISHOP:
+        return bishopAttacks(sq, occupiedBB) & ~own;
+    case PieceType::KNIGHT:
+        return KnightAttacks.sq[sq] & ~own;
+    case PieceType::PAWN: {
+        // Взятия по диагонали
+        Bitboard targets = PawnAttacks.sq[us][sq] & colorBB[us ^ 1];
+
+        // Ходы вперед на одну клетку и на две со стартовой горизонтали
+        int y = rankOf(sq);
+        int lastRow = (us == 0) ? 7 : 0;
+        int startRow = (us == 0) ? 1 : 6;
+        if (y != lastRow) {
+            int step = (us == 0) ? 8 : -8;
+            Bitboard push = squareBB(sq + step) & ~occupiedBB;
+            targets |= push;
+            if (push && y == startRow) {
+                targets |= squareBB(sq + 2 * step) & ~occupiedBB;
+            }
+        }
+        return targets;
+    }
+    default:
+        return 0;
+    }
+}
+
+// Фигуры цвета us, связанные с собственным королем
+Bitboard ChessBoard::pinnedPieces(int us, int kingSq) const {
+    const Bitboard(&enemy)[6] = pieces[us ^ 1];
+    Bitboard snipers = (rookAttacks(kingSq, 0) & (enemy[int(PieceType::ROOK)] | enemy[int(PieceType::QUEEN)]))
+                     | (bishopAttacks(kingSq, 0) & (enemy[int(PieceType::BISHOP)] | enemy[int(PieceType::QUEEN)]));
+    Bitboard pinned = 0;
+    while (snipers) {
+        // Связка - ровно одна фигура между королем и дальнобойной фигурой противника
+        Bitboard between = BetweenBB[kingSq][popLsb(snipers)] & occupiedBB;
+        if (between && !moreThanOne(between)) {
+            pinned |= between & colorBB[us];
+        }
+    }
+    return pinned;
+}
+
+// Ходы пешек без превращений: непривязанные пешки обрабатываются сразу всем битбордом
+void ChessBoard::generatePawnMoves(int us, GenType type, Bitboard mask, Bitboard pinned, int kingSq, MoveList& list) const {
+    Bitboard pawns = pieces[us][int(PieceType::PAWN)] & ~promotionRank(us);
+    Bitboard free = pawns & ~pinned;
+    Bitboard empty = ~occupiedBB;
+
+    if (type != GenType::CAPTURES) {
+        // Ходы вперед на одну клетку и на две со стартовой горизонтали
+        Bitboard startRow3 = (us == 0) ? (RANK_1_BB << 16) : (RANK_1_BB << 40);
+        Bitboard push1 = ((us == 0) ? (free << 8) : (free >> 8)) & empty;
+        Bitboard push2 = ((us == 0) ? ((push1 & startRow3) << 8) : ((push1 & startRow3) >> 8)) & empty;
+        addPawnMoves(list, push1 & mask, (us == 0) ? 8 : -8);
+        addPawnMoves(list, push2 & mask, (us == 0) ? 16 : -16);
+    }
+
+    if (type != GenType::QUIETS) {
+        // Взятия в сторону вертикали "a" и в сторону вертикали "h"
+        Bitboard targets = colorBB[us ^ 1] & mask;
+        Bitboard west = (us == 0) ? ((free & ~FILE_A_BB) << 7) : ((free & ~FILE_A_BB) >> 9);
+        Bitboard east = (us == 0) ? ((free & ~FILE_H_BB) << 9) : ((free & ~FILE_H_BB) >> 7);
+        addPawnMoves(list, west & targets, (us == 0) ? 7 : -9);
+        addPawnMoves(list, east & targets, (us == 0) ? 9 : -7);
+    }
+
+    // Связанные пешки ходят только вдоль линии связки
+    Bitboard bound = pawns & pinned;
+    while (bound) {
+        int from = popLsb(bound);
+        addMoves(list, from, pseudoTargets(from) & mask & LineBB[kingSq][from]);
+    }
+}
+
+// Превращения пешек с предпоследней горизонтали (вместе с ходами на месте взятия);
+// генерируются вместе со взятиями
+void ChessBoard::generatePromotions(int us, Bitboard checkMask, Bitboard pinned, int kingSq, MoveList& list) const {
+    Bitboard pawns = pieces[us][int(PieceType::PAWN)] & promotionRank(us);
+    Bitboard free = pawns & ~pinned;
+    Bitboard targets = colorBB[us ^ 1] & checkMask;
+
+    Bitboard push = ((us == 0) ? (free << 8) : (free >> 8)) & ~occupiedBB & checkMask;
+    Bitboard west = (us == 0) ? ((free & ~FILE_A_BB) << 7) : ((free & ~FILE_A_BB) >> 9);
+    Bitboard east = (us == 0) ? ((free & ~FILE_H_BB) << 9) : ((free & ~FILE_H_BB) >> 7);
+    addPawnPromotions(list, push, (us == 0) ? 8 : -8);
+    addPawnPromotions(list, west & targets, (us == 0) ? 7 : -9);
+    addPawnPromotions(list, east & targets, (us == 0) ? 9 : -7);
+
+    Bitboard bound = pawns & pinned;
+    while (bound) {
+        int from = popLsb(bound);
+        Bitboard moves = pseudoTargets(from) & checkMask & LineBB[kingSq][from];
+        while (moves) {
+            addPromotions(list, from, popLsb(moves));
+        }
+    }
+}
+
+// Взятия на проходе: после хода с доски уходят обе пешки, поэтому связка по
+// горизонтали проверяется прямым расчетом атак дальнобойных фигур на короля
+void ChessBoard::generateEnPassant(int us, Bitboard checkMask, int kingSq, MoveList& list) const {
+    int captured = epSquare ^ 8;
+    // При шахе взятие допустимо, только если шах дает сама прошедшая пешка
+    if (!(checkMask & (squareBB(epSquare) | squareBB(captured)))) {
+        return;
+    }
+
+    const Bitboard(&enemy)[6] = pieces[us ^ 1];
+    Bitboard rooks = enemy[int(PieceType::ROOK)] | enemy[int(PieceType::QUEEN)];
+    Bitboard bishops = enemy[int(PieceType::BISHOP)] | enemy[int(PieceType::QUEEN)];
+    Bitboard pawns = PawnAttacks.sq[us ^ 1][epSquare] & pieces[us][int(PieceType::PAWN)];
+    while (pawns) {
+        int from = popLsb(pawns);
+        Bitboard occupied = (occupiedBB ^ squareBB(from) ^ squareBB(captured)) | squareBB(epSquare);
+        if (kingSq >= 0 && ((rookAttacks(kingSq, occupied) & rooks) | (bishopAttacks(kingSq, occupied) & bishops))) {
+            continue;
+        }
+        list.add(encodeMove(from, epSquare, MOVE_EN_PASSANT));
+    }
+}
+
+// Рокировки: король и ладья не ходили, между ними пусто, поля, через которые
+// проходит король, не атакованы (шаха королю нет - проверено заранее)
+void ChessBoard::generateCastling(int us, MoveList& list) const {
+    int kingSq = makeSquare(4, 7 * us);
+    Bitboard rooks = unmovedBB & pieces[us][int(PieceType::ROOK)];
+    Bitboard enemy = colorBB[us ^ 1];
+
+    if ((rooks & squareBB(kingSq + 3))
+        && !(occupiedBB & (squareBB(kingSq + 1) | squareBB(kingSq + 2)))
+        && !(attackersTo(kingSq + 1, occupiedBB) & enemy)
+        && !(attackersTo(kingSq + 2, occupiedBB) & enemy)) {
+        list.add(encodeMove(kingSq, kingSq + 2, MOVE_CASTLING));
+    }
+    if ((rooks & squareBB(kingSq - 4))
+        && !(occupiedBB & (squareBB(kingSq - 1) | squareBB(kingSq - 2) | squareBB(kingSq - 3)))
+        && !(attackersTo(kingSq - 1, occupiedBB) & enemy)
+        && !(attackersTo(kingSq - 2, occupiedBB) & enemy)) {
+        list.add(encodeMove(kingSq, kingSq - 2, MOVE_CASTLING));
+    }
+}
+
+// Генерация допустимых ходов цвета color с помощью масок связок и шахов
+void ChessBoard::generateLegal(Color color, GenType type, MoveList& list) const {
+    PROFILE_SCOPE(GENERATE_MOVES);
+    int us = colorIndex(color);
+    int them = us ^ 1;
+    int kingSq = kingSquare(color);
+    Bitboard targetMask = (type == GenType::CAPTURES) ? colorBB[them]
+                        : (type == GenType::QUIETS) ? ~occupiedBB
+                        : ~colorBB[us];
+
+    Bitboard checkers = 0;
+    Bitboard pinned = 0;
+    if (kingSq >= 0) {
+        // Король не может встать под удар; сам король при проверке убирается с доски
+        Bitboard occupied = occupiedBB ^ squareBB(kingSq);
+        Bitboard targets = KingAttacks.sq[kingSq] & targetMask;
+        while (targets) {
+            int to = popLsb(targets);
+            if (!(attackersTo(to, occupied) & colorBB[them])) {
+                list.add(encodeMove(kingSq, to));
+            }
+        }
+
+        checkInfo(color, kingSq, checkers, pinned);
+    }
+
+    // При двойном шахе ходит только король
+    if (moreThanOne(checkers)) {
+        return;
+    }
+
+    // При шахе остальные фигуры могут только взять шахующую фигуру или закрыться
+    Bitboard checkMask = ~Bitboard(0);
+    if (checkers) {
+        checkMask = BetweenBB[kingSq][lsb(checkers)] | checkers;
+    }
+    Bitboard mask = targetMask & checkMask;
+
+    // Связанный конь ходить не может
+    Bitboard knights = pieces[us][int(PieceType::KNIGHT)] & ~pinned;
+    while (knights) {
+        int from = popLsb(knights);
+        addMoves(list, from, KnightAttacks.sq[from] & mask);
+    }
+
+    // Дальнобойные фигуры
+    Bitboard sliders = pieces[us][int(PieceType::QUEEN)] | pieces[us][int(PieceType::ROOK)]
+                     | pieces[us][int(PieceType::BISHOP)];
+    while (sliders) {
+        int from = popLsb(sliders);
+        Bitboard targets = sliderAttacks(from) & mask;
+        if (pinned & squareBB(from)) {
+            targets &= LineBB[kingSq][from];
+        }
+        addMoves(list, from, targets);
+    }
+
+    generatePawnMoves(us, type, mask, pinned, kingSq, list);
+
+    // Особые ходы: в типичной позиции ни одна проверка не проходит и до вызова не доходит
+    if (type != GenType::QUIETS && (pieces[us][int(PieceType::PAWN)] & promotionRank(us))) {
+        generatePromotions(us, checkMask, pinned, kingSq, list);
+    }
+    if (epSquare >= 0 && type != GenType::QUIETS
+        && (PawnAttacks.sq[them][epSquare] & pieces[us][int(PieceType::PAWN)])) {
+        generateEnPassant(us, checkMask, kingSq, list);
+    }
+    if ((unmovedBB & pieces[us][int(PieceType::KING)]) && !checkers && type != GenType::CAPTURES
+        && castlingPathFree(us)) {
+        generateCastling(us, list);
+    }
+}
+
+// Есть ли у цвета color хотя бы один допустимый ход
+bool ChessBoard::hasLegalMoves(Color color) const {
+    PROFILE_SCOPE(HAS_LEGAL_MOVES);
+    int us = colorIndex(color);
+    int them = us ^ 1;
+    int kingSq = kingSquare(color);
+
+    // Те же маски, что и в generateLegal, но до первого найденного хода. Рокировка
+    // не проверяется: если она возможна, то возможен и ход короля на соседнюю клетку
+    Bitboard checkers = 0;
+    Bitboard pinned = 0;
+    if (kingSq >= 0) {
+        Bitboard occupied = occupiedBB ^ squareBB(kingSq);
+        Bitboard targets = KingAttacks.sq[kingSq] & ~colorBB[us];
+        while (targets) {
+            if (!(attackersTo(popLsb(targets), occupied) & colorBB[them])) {
+                return true;
+            }
+        }
+        checkInfo(color, kingSq, checkers, pinned);
+    }
+    if (moreThanOne(checkers)) {
+        return false;
+    }
+
+    Bitboard checkMask = ~Bitboard(0);
+    if (checkers) {
+        checkMask = BetweenBB[kingSq][lsb(checkers)] | checkers;
+    }
+    Bitboard mask = ~colorBB[us] & checkMask;
+
+    Bitboard knights = pieces[us][int(PieceType::KNIGHT)] & ~pinned;
+    while (knights) {
+        if (KnightAttacks.sq[popLsb(knights)] & mask) {
+            return true;
+        }
+    }
+
+    Bitboard sliders = pieces[us][int(PieceType::QUEEN)] | pieces[us][int(PieceType::ROOK)]
+                     | pieces[us][int(PieceType::BISHOP)];
+    while (sliders) {
+        int from = popLsb(sliders);
+        Bitboard targets = sliderAttacks(from) & mask;
+        if (pinned & squareBB(from)) {
+            targets &= LineBB[kingSq][from];
+        }
+        if (targets) {
+            return true;
+        }
+    }
+
+    // Пешки остаются последними: их ходы проще сгенерировать, чем проверять по одному
+    MoveList list;
+    generatePawnMoves(us, GenType::ALL, mask, pinned, kingSq, list);
+    if (pieces[us][int(PieceType::PAWN)] & promotionRank(us)) {
+        generatePromotions(us, checkMask, pinned, kingSq, list);
+    }
+    if (epSquare >= 0 && (PawnAttacks.sq[them][epSquare] & pieces[us][int(PieceType::PAWN)])) {
+        generateEnPassant(us, checkMask, kingSq, list);
+    }
+    return !list.empty();
+}
+
+// Инициализация доски в зависимости от уровня сложности
+void ChessBoard::clearBoard() {
+    for (int c = 0; c < 2; ++c) {
+        for (int t = 0; t < 6; ++t) {
+            pieces[c][t] = 0;
+        }
+        colorBB[c] = 0;
+    }
+    occupiedBB = 0;
+    unmovedBB = 0;
+    pawnKey = 0;
+    psqMg = 0;
+    psqEg = 0;
+    phase = 0;
+    for (int sq = 0; sq < 64; ++sq) {
+        mailbox[sq] = PieceType::NONE;
+    }
+    currentPlayer = Color::WHITE;
+    epSquare = -1;
+    rule50 = 0;
+    history.clear();
+    startPly = 0;
+    gameOver = false;
+}
+
+void ChessBoard::initializeBoard() {
+    clearBoard();
+
+    if (difficulty == 1) {
+        // Режим 1: только кони и короли
+        putPiece(makeSquare(4, 0), PieceType::KING, Color::WHITE);   // Белый король
+        putPiece(makeSquare(1, 0), PieceType::KNIGHT, Color::WHITE); // Белый конь
+        putPiece(makeSquare(6, 0), PieceType::KNIGHT, Color::WHITE); // Белый конь
+
+        putPiece(makeSquare(4, 7), PieceType::KING, Color::BLACK);   // Черный король
+        putPiece(makeSquare(1, 7), PieceType::KNIGHT, Color::BLACK); // Черный конь
+        putPiece(makeSquare(6, 7), PieceType::KNIGHT, Color::BLACK); // Черный конь
+    }
+    else if (difficulty == 2) {
+        // Режим 2: только пешки и короли
+        putPiece(makeSquare(4, 0), PieceType::KING, Color::WHITE); // Белый король
+        for (int x = 0; x < 8; ++x) {
+            putPiece(makeSquare(x, 1), PieceType::PAWN, Color::WHITE); // Белые пешки
+        }
+
+        putPiece(makeSquare(4, 7), PieceType::KING, Color::BLACK); // Черный король
+        for (int x = 0; x < 8; ++x) {
+            putPiece(makeSquare(x, 6), PieceType::PAWN, Color::BLACK); // Черные пешки
+        }
+    }
+    else {
+        // Режим 3: стандартные шахматы
+        const PieceType backRank[8] = {
+            PieceType::ROOK, PieceType::KNIGHT, PieceType::BISHOP, PieceType::QUEEN,
+            PieceType::KING, PieceType::BISHOP, PieceType::KNIGHT, PieceType::ROOK
+        };
+
+        // Расстановка белых и черных фигур
+        for (int x = 0; x < 8; ++x) {
+            putPiece(makeSquare(x, 0), backRank[x], Color::WHITE);
+            putPiece(makeSquare(x, 1), PieceType::PAWN, Color::WHITE);
+            putPiece(makeSquare(x, 7), backRank[x], Color::BLACK);
+            putPiece(makeSquare(x, 6), PieceType::PAWN, Color::BLACK);
+        }
+    }
+
+    // В начальной позиции ни одна фигура еще не ходила
+    unmovedBB = occupiedBB;
+    key = computeKey();
+    checkInfoValid = 0;
+}
+
+// Поиск хода среди допустимых: все правила (связки, шах, рокировка, взятие на
+// проходе, превращение) уже учтены генератором
+Move ChessBoard::findMove(int from, int to, PieceType promotion) const {
+    MoveList list;
+    generateMoves(list);
+    for (Move move : list) {
+        if (moveFrom(move) == from && moveTo(move) == to
+            && (moveType(move) != MOVE_PROMOTION || promotionType(move) == promotion)) {
+            return move;
+        }
+    }
+    return MOVE_NONE;
+}
+
+// Проверка правильности хода
+bool ChessBoard::isMoveValid(const Position& from, const Position& to) const {
+    PROFILE_SCOPE(IS_MOVE_VALID);
+    // Проверка на выход за пределы доски
+    if (!isPositionValid(from) || !isPositionValid(to)) {
+        return false;
+    }
+    return findMove(makeSquare(from.x, from.y), makeSquare(to.x, to.y)) != MOVE_NONE;
+}
+
+bool ChessBoard::isLegal(Move move) const {
+    MoveList list;
+    generateMoves(list);
+    return move != MOVE_NONE && list.contains(move);
+}
+
+// Проверка, находится ли король под шахом
+bool ChessBoard::isInCheck(Color color) const {
+    PROFILE_SCOPE(IS_IN_CHECK);
+    if (color == currentPlayer) {
+        return currentCheckers() != 0;
+    }
+    int kingSq = kingSquare(color);
+    if (kingSq < 0) {
+        return false;
+    }
+    return (attackersTo(kingSq, occupiedBB) & colorBB[colorIndex(opposite(color))]) != 0;
+}
+
+// Проверка на мат: шах и нет ни одного допустимого хода
+bool ChessBoard::isCheckmate(Color color) const {
+    PROFILE_SCOPE(IS_CHECKMATE);
+    return isInCheck(color) && !hasLegalMoves(color);
+}
+
+// Проверка на пат: шаха нет, но и ходить некуда
+bool ChessBoard::isStalemate(Color color) const {
+    PROFILE_SCOPE(IS_STALEMATE);
+    return !isInCheck(color) && !hasLegalMoves(color);
+}
+
+// Повторения ищутся только среди позиций с той же очередью хода (через полуход)
+// после последнего необратимого хода
+int ChessBoard::repetitionCount() const {
+    int count = 0;
+    int last = int(history.size());
+    int stop = std::max(0, last - rule50);
+    for (int i = last - 2; i >= stop; i -= 2) {
+        if (history[i].key == key) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+// Разбор хода "e2e4" ("e7e8q") среди допустимых ходов текущего игрока;
+// без буквы фигуры пешка превращается в ферзя
+Move ChessBoard::parseMove(const std::string& text) const {
+    if (text.length() != 4 && text.length() != 5) {
+        return MOVE_NONE;
+    }
+    int from = parseSquare(text.substr(0, 2));
+    int to = parseSquare(text.substr(2, 2));
+    if (from < 0 || to < 0) {
+        return MOVE_NONE;
+    }
+
+    PieceType promotion = PieceType::QUEEN;
+    if (text.length() == 5) {
+        size_t piece = std::string("qrbn").find(char(tolower(text[4])));
+        if (piece == std::string::npos) {
+            return MOVE_NONE;
+        }
+        promotion = PieceType(int(PieceType::QUEEN) + int(piece));
+    }
+
+    Move move = findMove(from, to, promotion);
+    if (text.length() == 5 && moveType(move) != MOVE_PROMOTION) {
+        return MOVE_NONE;
+    }
+    return move;
+}
+
+// Разбор хода в краткой алгебраической нотации
+Move ChessBoard::parseSan(std::string_view san) const {
+    static const std::string_view pieceLetters = "KQRBN";
+
+    // Пометки шаха, мата и оценки хода на выбор хода не влияют
+    while (!san.empty() && std::string_view("+#!?").find(san.back()) != std::string_view::npos) {
+        san.remove_suffix(1);
+    }
+    if (san.size() < 2) {
+        return MOVE_NONE;
+    }
+
+    MoveList list;
+    generateMoves(list);
+
+    // Рокировка: "O-O", "O-O-O" (встречается и запись нулями)
+    if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+        bool queenSide = san.size() == 5;
+        for (Move move : list) {
+            if (moveType(move) == MOVE_CASTLING && (moveTo(move) < moveFrom(move)) == queenSide) {
+                return move;
+            }
+        }
+        return MOVE_NONE;
+    }
+
+    // Превращение: "e8=Q", "exd8=N" или без знака равенства "e8Q"
+    PieceType promotion = PieceType::NONE;
+    if (san.size() >= 3 && pieceLetters.find(san.back()) != std::string_view::npos && san.back() != 'K') {
+        promotion = PieceType(pieceLetters.find(san.back()));
+        san.remove_suffix(1);
+        if (san.back() == '=') {
+            san.remove_suffix(1);
+        }
+    }
+
+    PieceType type = PieceType::PAWN;
+    size_t begin = 0;
+    size_t letter = pieceLetters.find(san[0]);
+    if (letter != std::string_view::npos) {
+        type = PieceType(letter);
+        begin = 1;
+    }
+
+    // Последние два символа - поле назначения, перед ними - уточнение откуда
+    // (после снятия превращения от "e=Q" может остаться один символ)
+    if (san.size() < begin + 2) {
+        return MOVE_NONE;
+    }
+    size_t end = san.size() - 2;
+    int toX = san[end] - 'a';
+    int toY = san[end + 1] - '1';
+    if (toX < 0 || toX > 7 || toY < 0 || toY > 7) {
+        return MOVE_NONE;
+    }
+    int to = makeSquare(toX, toY);
+
+    int fileHint = -1;
+    int rankHint = -1;
+    for (size_t i = begin; i < end; ++i) {
+        char c = san[i];
+        if (c >= 'a' && c <= 'h') {
+            fileHint = c - 'a';
+        }
+        else if (c >= '1' && c <= '8') {
+            rankHint = c - '1';
+        }
+        else if (c != 'x' && c != '-') {
+            return MOVE_NONE;
+        }
+    }
+
+    Move found = MOVE_NONE;
+    for (Move move : list) {
+        int from = moveFrom(move);
+        PieceType promoted = moveType(move) == MOVE_PROMOTION ? promotionType(move) : PieceType::NONE;
+        if (moveTo(move) != to || mailbox[from] != type || promoted != promotion
+            || moveType(move) == MOVE_CASTLING
+            || (fileHint >= 0 && fileOf(from) != fileHint)
+            || (rankHint >= 0 && rankOf(from) != rankHint)) {
+            continue;
+        }
+        if (found != MOVE_NONE) {
+            return MOVE_NONE; // Неоднозначная запись
+        }
+        found = move;
+    }
+    return found;
+}
+
+// Выполнение хода
+bool ChessBoard::makeMove(const Position& from, const Position& to, PieceType promotion) {
+    PROFILE_SCOPE(MAKE_MOVE_CHECKED);
+    if (!isPositionValid(from) || !isPositionValid(to)) {
+        return false;
+    }
+
+    // Ход ищется среди допустимых, поэтому невозможно оставить короля под шахом
+    Move move = findMove(makeSquare(from.x, from.y), makeSquare(to.x, to.y), promotion);
+    if (move == MOVE_NONE) {
+        return false;
+    }
+
+    // Выполняем ход и передаем ход другому игроку
+    makeMove(move);
+
+    // Партия окончена, если у соперника нет ходов (мат или пат) или ничья по правилам
+    gameOver = !hasLegalMoves(currentPlayer) || isDrawByRule();
+
+    return true;
+}
+
+// Выполнение заведомо допустимого хода за O(1) с записью в стек отмены
+void ChessBoard::makeMove(Move move) {
+    PROFILE_SCOPE(MAKE_MOVE);
+    int from = moveFrom(move);
+    int to = moveTo(move);
+    int us = colorIndex(currentPlayer);
+    PieceType moved = mailbox[from];
+    PieceType captured = mailbox[to];
+
+    history.push_back({ move, captured, int8_t(epSquare), uint16_t(rule50), unmovedBB, key });
+
+    // Ключ обновляется приращениями: убираем старые права и взятие на проходе
+    int oldRights = castlingRights();
+    key ^= enPassantKey();
+
+    if (moveType(move) == MOVE_NORMAL) {
+        if (captured != PieceType::NONE) {
+            key ^= Zobrist.piece[us ^ 1][int(captured)][to];
+            removePiece(to);
+        }
+        movePiece(from, to, us);
+        key ^= Zobrist.piece[us][int(moved)][from] ^ Zobrist.piece[us][int(moved)][to];
+    }
+    else {
+        makeSpecialMove(move, us);
+    }
+    unmovedBB &= ~(squareBB(from) | squareBB(to));
+
+    // Ход пешки и взятие (в том числе на проходе - это ход пешки) необратимы
+    rule50 = (moved == PieceType::PAWN || captured != PieceType::NONE) ? 0 : rule50 + 1;
+
+    // Запоминаем поле, через которое прошла пешка двойным ходом
+    epSquare = (moved == PieceType::PAWN && (to - from == 16 || from - to == 16)) ? (from + to) / 2 : -1;
+
+    currentPlayer = opposite(currentPlayer);
+    key ^= Zobrist.side ^ enPassantKey();
+    int newRights = castlingRights();
+    if (newRights != oldRights) {
+        key ^= Zobrist.castling[oldRights] ^ Zobrist.castling[newRights];
+    }
+    checkInfoValid = 0;
+    VERIFY_HASH();
+}
+
+bool ChessBoard::isMoveWellFormed(Move move) const {
+    int from = moveFrom(move);
+    int to = moveTo(move);
+    int us = colorIndex(currentPlayer);
+    Bitboard targets = ~colorBB[us] & ~pieces[us ^ 1][int(PieceType::KING)];
+    if (!(colorBB[us] & squareBB(from)) || !(targets & squareBB(to))) {
+        return false;
+    }
+
+    PieceType moved = mailbox[from];
+    bool lastRank = rankOf(to) == (us == 0 ? 7 : 0);
+    switch (moveType(move)) {
+    case MOVE_NORMAL:
+        return moved != PieceType::PAWN || !lastRank;
+    case MOVE_PROMOTION:
+        return moved == PieceType::PAWN && lastRank;
+    case MOVE_EN_PASSANT:
+        return moved == PieceType::PAWN && to == epSquare && mailbox[to] == PieceType::NONE
+            && (pieces[us ^ 1][int(PieceType::PAWN)] & squareBB(to ^ 8));
+    default: {
+        // Рокировка: король с исходного поля на два поля в сторону своей ладьи
+        int rookFrom = (to > from) ? from + 3 : from - 4;
+        return moved == PieceType::KING && from == makeSquare(4, 7 * us) && (to == from + 2 || to == from - 2)
+            && (pieces[us][int(PieceType::ROOK)] & squareBB(rookFrom))
+            && mailbox[to] == PieceType::NONE && mailbox[(from + to) / 2] == PieceType::NONE;
+    }
+    }
+}
+
+// Отмена последнего хода из стека
+void ChessBoard::unmakeMove() {
+    PROFILE_SCOPE(UNMAKE_MOVE);
+    const UndoInfo& undo = history.back();
+    int from = moveFrom(undo.move);
+    int to = moveTo(undo.move);
+
+    currentPlayer = opposite(currentPlayer);
+    if (moveType(undo.move) == MOVE_NORMAL) {
+        movePiece(to, from, colorIndex(currentPlayer));
+        if (undo.captured != PieceType::NONE) {
+            putPiece(to, undo.captured, opposite(currentPlayer));
+        }
+    }
+    else {
+        unmakeSpecialMove(undo);
+    }
+    unmovedBB = undo.unmoved;
+    epSquare = undo.epSquare;
+    rule50 = undo.rule50;
+    key = undo.key;
+    checkInfoValid = 0;
+
+    history.pop_back();
+    VERIFY_HASH();
+}
+
+// Превращение, взятие на проходе и рокировка; ключ обновляется здесь же,
+// права на рокировку и поле взятия на проходе - в makeMove
+void ChessBoard::makeSpecialMove(Move move, int us) {
+    int from = moveFrom(move);
+    int to = moveTo(move);
+    const uint64_t(&keys)[6][64] = Zobrist.piece[us];
+
+    switch (moveType(move)) {
+    case MOVE_PROMOTION: {
+        PieceType captured = mailbox[to];
+        if (captured != PieceType::NONE) {
+            key ^= Zobrist.piece[us ^ 1][int(captured)][to];
+            removePiece(to);
+        }
+        PieceType promoted = promotionType(move);
+        removePiece(from);
+        putPiece(to, promoted, currentPlayer);
+        key ^= keys[int(PieceType::PAWN)][from] ^ keys[int(promoted)][to];
+        break;
+    }
+    case MOVE_EN_PASSANT: {
+        int captured = to ^ 8;     // Пешка соперника стоит рядом, на горизонтали "откуда"
+        removePiece(captured);
+        movePiece(from, to, us);
+        key ^= Zobrist.piece[us ^ 1][int(PieceType::PAWN)][captured]
+             ^ keys[int(PieceType::PAWN)][from] ^ keys[int(PieceType::PAWN)][to];
+        break;
+    }
+    default: {
+        // Рокировка: ладья перепрыгивает через короля на соседнее с ним поле
+        int rookFrom = (to > from) ? from + 3 : from - 4;
+        int rookTo = (from + to) / 2;
+        movePiece(from, to, us);
+        movePiece(rookFrom, rookTo, us);
+        key ^= keys[int(PieceType::KING)][from] ^ keys[int(PieceType::KING)][to]
+             ^ keys[int(PieceType::ROOK)][rookFrom] ^ keys[int(PieceType::ROOK)][rookTo];
+        unmovedBB &= ~squareBB(rookFrom);
+        break;
+    }
+    }
+}
+
+void ChessBoard::unmakeSpecialMove(const UndoInfo& undo) {
+    int from = moveFrom(undo.move);
+    int to = moveTo(undo.move);
+    int us = colorIndex(currentPlayer);
+
+    switch (moveType(undo.move)) {
+    case MOVE_PROMOTION:
+        removePiece(to);
+        putPiece(from, PieceType::PAWN, currentPlayer);
+        if (undo.captured != PieceType::NONE) {
+            putPiece(to, undo.captured, opposite(currentPlayer));
+        }
+        break;
+    case MOVE_EN_PASSANT:
+        movePiece(to, from, us);
+        putPiece(to ^ 8, PieceType::PAWN, opposite(currentPlayer));
+        break;
+    default:
+        movePiece(to, from, us);
+        movePiece((from + to) / 2, (to > from) ? from + 3 : from - 4, us);
+        break;
+    }
+}
+
+bool ChessBoard::isInsufficientMaterial() const {
+    for (int c = 0; c < 2; ++c) {
+        if (pieces[c][int(PieceType::PAWN)] | pieces[c][int(PieceType::ROOK)] | pieces[c][int(PieceType::QUEEN)]) {
+            return false;
+        }
+    }
+    Bitboard knights = pieces[0][int(PieceType::KNIGHT)] | pieces[1][int(PieceType::KNIGHT)];
+    Bitboard bishops = pieces[0][int(PieceType::BISHOP)] | pieces[1][int(PieceType::BISHOP)];
+    if (popCount(knights | bishops) <= 1) {
+        return true;
+    }
+    return !knights && (!(bishops & DARK_SQUARES_BB) || !(bishops & ~DARK_SQUARES_BB));
+}
+
+// Права на рокировку задаются через "нетронутые" короля и ладьи
+bool ChessBoard::setCastlingRights(int rights) {
+    bool applied = true;
+    for (int i = 0; i < 4; ++i) {
+        int color = i / 2;
+        int kingSq = makeSquare(4, 7 * color);
+        int rookSq = makeSquare(i % 2 == 0 ? 7 : 0, 7 * color);
+        if (!(rights & (1 << i))) {
+            continue;
+        }
+        if ((pieces[color][int(PieceType::KING)] & squareBB(kingSq))
+            && (pieces[color][int(PieceType::ROOK)] & squareBB(rookSq))) {
+            unmovedBB |= squareBB(kingSq) | squareBB(rookSq);
+        }
+        else {
+            applied = false;
+        }
+    }
+
+    // Пешки на стартовых горизонталях тоже считаются нетронутыми
+    unmovedBB |= (pieces[0][int(PieceType::PAWN)] & (RANK_1_BB << 8))
+               | (pieces[1][int(PieceType::PAWN)] & (RANK_1_BB << 48));
+    return applied;
+}
+
+bool ChessBoard::isPlausibleSetup() const {
+    Bitboard pawns = pieces[0][int(PieceType::PAWN)] | pieces[1][int(PieceType::PAWN)];
+    return popCount(colorBB[0]) <= 16 && popCount(colorBB[1]) <= 16
+        && !(pawns & (RANK_1_BB | RANK_8_BB))
+        && !isInCheck(opposite(currentPlayer));
+}
+
+bool ChessBoard::isEnPassantPlausible(int sq) const {
+    if (sq < 0 || sq >= 64) {
+        return false;
+    }
+    int us = colorIndex(currentPlayer);
+    int from = us == 0 ? sq + 8 : sq - 8;
+    return rankOf(sq) == (us == 0 ? 5 : 2)
+        && !(occupiedBB & (squareBB(sq) | squareBB(from)))
+        && (pieces[us ^ 1][int(PieceType::PAWN)] & squareBB(sq ^ 8));
+}
+
+bool ChessBoard::loadFen(const std::string& fen) {
+    static const std::string pieceChars = "kqrbnp";
+
+    std::istringstream in(fen);
+    std::string placement, side, castling = "-", ep = "-";
+    int halfmove = 0, fullmove = 1;
+    if (!(in >> placement >> side)) {
+        initializeBoard();
+        return false;
+    }
+    in >> castling >> ep >> halfmove >> fullmove;
+
+    clearBoard();
+    bool ok = true;
+
+    // Расстановка фигур: горизонтали от 8-й к 1-й, разделенные '/'
+    int x = 0, y = 7;
+    for (char c : placement) {
+        if (c == '/') {
+            ok = ok && x == 8 && y > 0;
+            x = 0;
+            --y;
+        }
+        else if (c >= '1' && c <= '8') {
+            x += c - '0';
+            ok = ok && x <= 8;
+        }
+        else {
+            size_t type = pieceChars.find(char(tolower(c)));
+            if (type == std::string::npos || x > 7 || y < 0) {
+                ok = false;
+                break;
+            }
+            putPiece(makeSquare(x, y), PieceType(type), isupper(c) ? Color::WHITE : Color::BLACK);
+            ++x;
+        }
+    }
+    ok = ok && x == 8 && y == 0;
+    ok = ok && popCount(pieces[0][int(PieceType::KING)]) == 1 && popCount(pieces[1][int(PieceType::KING)]) == 1;
+    ok = ok && (side == "w" || side == "b");
+    if (ok) {
+        currentPlayer = (side == "w") ? Color::WHITE : Color::BLACK;
+        ok = isPlausibleSetup();
+    }
+    if (!ok) {
+        initializeBoard();
+        return false;
+    }
+
+    static const std::string rightChars = "KQkq";
+    int rights = 0;
+    for (char c : castling) {
+        size_t bit = rightChars.find(c);
+        if (bit != std::string::npos) {
+            rights |= 1 << bit;
+        }
+    }
+    setCastlingRights(rights);
+
+    // Поле взятия на проходе принимается, только если за ним стоит пешка, сделавшая двойной ход
+    epSquare = parseSquare(ep);
+    if (epSquare >= 0 && !isEnPassantPlausible(epSquare)) {
+        epSquare = -1;
+    }
+    rule50 = halfmove > 0 ? halfmove : 0;
+    startPly = 2 * (fullmove > 0 ? fullmove - 1 : 0) + (currentPlayer == Color::BLACK ? 1 : 0);
+    key = computeKey();
+    checkInfoValid = 0;
+    gameOver = !hasLegalMoves(currentPlayer);
+    return true;
+}
+
+std::string ChessBoard::toFen() const {
+    static const char pieceChars[] = "kqrbnp";
+
+    std::string fen;
+    for (int y = 7; y >= 0; --y) {
+        int empty = 0;
+        for (int x = 0; x < 8; ++x) {
+            Piece piece = pieceAt(makeSquare(x, y));
+            if (piece.type == PieceType::NONE) {
+                ++empty;
+                continue;
+            }
+            if (empty) {
+                fen += char('0' + empty);
+                empty = 0;
+            }
+            char c = pieceChars[int(piece.type)];
+            fen += (piece.color == Color::WHITE) ? char(toupper(c)) : c;
+        }
+        if (empty) {
+            fen += char('0' + empty);
+        }
+        if (y > 0) {
+            fen += '/';
+        }
+    }
+
+    fen += (currentPlayer == Color::WHITE) ? " w " : " b ";
+
+    int rights = castlingRights();
+    if (!rights) {
+        fen += '-';
+    }
+    const char rightChars[] = "KQkq";
+    for (int i = 0; i < 4; ++i) {
+        if (rights & (1 << i)) {
+            fen += rightChars[i];
+        }
+    }
+
+    fen += ' ';
+    fen += (epSquare >= 0) ? squareName(epSquare) : "-";
+
+    int ply = startPly + int(history.size());
+    fen += " " + std::to_string(rule50) + " " + std::to_string(ply / 2 + 1);
+    return fen;
+}
+
+bool ChessBoard::pack(PackedPosition& packed) const {
+    packed = PackedPosition();
+    if (popCount(occupiedBB) > PackedPosition::MAX_PIECES) {
+        return false;
+    }
+    packed.occupied = occupiedBB;
+
+    Bitboard occupied = occupiedBB;
+    for (int i = 0; occupied; ++i) {
+        int sq = popLsb(occupied);
+        int code = int(mailbox[sq]) + ((colorBB[1] & squareBB(sq)) ? PackedPosition::BLACK_PIECE : 0);
+        packed.setPieceCode(i, code);
+    }
+
+    packed.flags = uint8_t((currentPlayer == Color::BLACK ? PackedPosition::BLACK_FLAG : 0)
+                         | (castlingRights() << PackedPosition::CASTLING_SHIFT));
+    packed.epSquare = int8_t(epSquare);
+    packed.halfmove = uint8_t(rule50 < 255 ? rule50 : 255);
+    packed.ply = uint16_t(gamePly());
+    return true;
+}
+
+bool ChessBoard::unpack(const PackedPosition& packed) {
+    clearBoard();
+
+    bool ok = popCount(packed.occupied) <= PackedPosition::MAX_PIECES;
+    Bitboard occupied = ok ? packed.occupied : 0;
+    for (int i = 0; occupied; ++i) {
+        int sq = popLsb(occupied);
+        int code = packed.pieceCode(i);
+        int type = code & (PackedPosition::BLACK_PIECE - 1);
+        if (type >= int(PieceType::NONE)) {
+            ok = false;
+            break;
+        }
+        putPiece(sq, PieceType(type), (code & PackedPosition::BLACK_PIECE) ? Color::BLACK : Color::WHITE);
+    }
+    ok = ok && popCount(pieces[0][int(PieceType::KING)]) == 1 && popCount(pieces[1][int(PieceType::KING)]) == 1;
+
+    // Права на рокировку и взятие на проходе должны соответствовать расстановке
+    currentPlayer = (packed.flags & PackedPosition::BLACK_FLAG) ? Color::BLACK : Color::WHITE;
+    ok = ok && isPlausibleSetup();
+    ok = ok && setCastlingRights((packed.flags >> PackedPosition::CASTLING_SHIFT) & 0xF);
+    ok = ok && (packed.epSquare == -1 || isEnPassantPlausible(packed.epSquare));
+    if (!ok) {
+        initializeBoard();
+        return false;
+    }
+
+    epSquare = packed.epSquare;
+    rule50 = packed.halfmove;
+    startPly = packed.ply;
+    key = computeKey();
+    checkInfoValid = 0;
+    gameOver = !hasLegalMoves(currentPlayer);
+    return true;
+}
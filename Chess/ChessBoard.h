@@ -0,0 +1,470 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Bitboard.h"
+#include "Move.h"
+#include "PackedPosition.h"
+#include "Psqt.h"
+#include "Zobrist.h"
+
+// Типы шахматных фигур
+enum class PieceType { KING, QUEEN, ROOK, BISHOP, KNIGHT, PAWN, NONE };
+
+// Цвета фигур
+enum class Color { WHITE, BLACK, NONE };
+
+// Фигура превращения хода и ее код для encodeMove (конь 0 ... ферзь 3)
+inline PieceType promotionType(Move m) {
+    return PieceType(int(PieceType::KNIGHT) - movePromotion(m));
+}
+
+inline int promotionCode(PieceType type) {
+    return int(PieceType::KNIGHT) - int(type);
+}
+
+// Структура, представляющая шахматную фигуру
+struct Piece {
+    PieceType type = PieceType::NONE; // Тип фигуры
+    Color color = Color::NONE;        // Цвет фигуры
+    bool hasMoved = false;            // Флаг, указывающий, двигалась ли фигура
+};
+
+// Структура для позиции на доске (x - столбец, y - строка)
+struct Position {
+    int x; // 0-7 (a-h)
+    int y; // 0-7 (1-8)
+};
+
+// Запись стека отмены: все, что нельзя восстановить по самому ходу
+struct UndoInfo {
+    Move move;              // Сделанный ход
+    PieceType captured;     // Взятая фигура (NONE, если взятия не было)
+    int8_t epSquare;        // Клетка взятия на проходе до хода (-1, если нет)
+    uint16_t rule50;        // Счетчик правила 50 ходов до хода
+    Bitboard unmoved;       // Нетронутые фигуры до хода (права на рокировку)
+    uint64_t key;           // Ключ Зобриста до хода
+};
+
+// Запись хода в координатной нотации ("e2e4", превращение - "e7e8q")
+std::string moveToString(Move move);
+
+// Название клетки ("e4") и обратное преобразование (-1 при ошибке)
+std::string squareName(int sq);
+int parseSquare(const std::string& name);
+
+// Класс, представляющий шахматную доску и правила игры (без ввода-вывода)
+class ChessBoard {
+private:
+    // Емкость стека отмены, резервируемая при создании партии
+    static const int HISTORY_RESERVE = 512;
+
+    // Позиция хранится в битбордах: по одному на каждый тип фигуры и цвет
+    Bitboard pieces[2][6] = {};         // [цвет][тип фигуры]
+    Bitboard colorBB[2] = {};           // Занятость по цветам
+    Bitboard occupiedBB = 0;            // Все занятые клетки
+    PieceType mailbox[64];              // Тип фигуры на клетке (для быстрого доступа)
+    Bitboard unmovedBB = 0;             // Фигуры, которые еще не ходили (Piece::hasMoved)
+    Color currentPlayer = Color::WHITE; // Текущий игрок
+    int epSquare = -1;                  // Поле, через которое пешка прошла двойным ходом
+    uint64_t key = 0;                   // Ключ Зобриста текущей позиции
+    uint64_t pawnKey = 0;               // Ключ Зобриста одних пешек (для пешечного хеша)
+    int psqMg = 0;                      // Материал и таблицы фигура-клетка (белые минус черные),
+    int psqEg = 0;                      // миттельшпиль и эндшпиль; ведутся при каждом ходе
+    int phase = 0;                      // Стадия партии (сумма PhaseWeight фигур)
+    int rule50 = 0;                     // Полуходы без взятий и ходов пешек
+    std::vector<UndoInfo> history;      // Стек отмены ходов
+    int startPly = 0;                   // Номер полухода, с которого началась партия
+    bool gameOver = false;           // Флаг окончания игры
+    mutable uint8_t checkInfoValid = 0; // Какие маски (CHECKERS_VALID, PINS_VALID) соответствуют позиции
+    int difficulty = 3;              // Уровень сложности (1-3)
+    mutable Bitboard checkersBB = 0; // Фигуры противника, объявившие шах текущему игроку
+    mutable Bitboard pinnedBB = 0;   // Фигуры текущего игрока, связанные с его королем
+
+    static int colorIndex(Color color) {
+        return color == Color::WHITE ? 0 : 1;
+    }
+
+    static Color opposite(Color color) {
+        return color == Color::WHITE ? Color::BLACK : Color::WHITE;
+    }
+
+    // Постановка фигуры на пустую клетку
+    void putPiece(int sq, PieceType type, Color color) {
+        Bitboard b = squareBB(sq);
+        int c = colorIndex(color);
+        pieces[c][int(type)] |= b;
+        colorBB[c] |= b;
+        occupiedBB |= b;
+        mailbox[sq] = type;
+        if (type == PieceType::PAWN) {
+            pawnKey ^= Zobrist.piece[c][int(PieceType::PAWN)][sq];
+        }
+        psqMg += Psqt.mg[c][int(type)][sq];
+        psqEg += Psqt.eg[c][int(type)][sq];
+        phase += PhaseWeight[int(type)];
+    }
+
+    // Снятие фигуры с клетки
+    void removePiece(int sq) {
+        Bitboard b = squareBB(sq);
+        int c = (colorBB[0] & b) ? 0 : 1;
+        int type = int(mailbox[sq]);
+        pieces[c][type] &= ~b;
+        colorBB[c] &= ~b;
+        occupiedBB &= ~b;
+        mailbox[sq] = PieceType::NONE;
+        if (type == int(PieceType::PAWN)) {
+            pawnKey ^= Zobrist.piece[c][type][sq];
+        }
+        psqMg -= Psqt.mg[c][type][sq];
+        psqEg -= Psqt.eg[c][type][sq];
+        phase -= PhaseWeight[type];
+    }
+
+    // Перемещение фигуры цвета c на пустую клетку
+    void movePiece(int from, int to, int c) {
+        Bitboard fromTo = squareBB(from) | squareBB(to);
+        int type = int(mailbox[from]);
+        pieces[c][type] ^= fromTo;
+        colorBB[c] ^= fromTo;
+        occupiedBB ^= fromTo;
+        mailbox[to] = mailbox[from];
+        mailbox[from] = PieceType::NONE;
+        if (type == int(PieceType::PAWN)) {
+            pawnKey ^= Zobrist.piece[c][type][from] ^ Zobrist.piece[c][type][to];
+        }
+        psqMg += Psqt.mg[c][type][to] - Psqt.mg[c][type][from];
+        psqEg += Psqt.eg[c][type][to] - Psqt.eg[c][type][from];
+    }
+
+    // Фигура на клетке в виде структуры Piece
+    Piece pieceAt(int sq) const {
+        Bitboard b = squareBB(sq);
+        if (!(occupiedBB & b)) {
+            return Piece();
+        }
+        return { mailbox[sq], (colorBB[0] & b) ? Color::WHITE : Color::BLACK, !(unmovedBB & b) };
+    }
+
+    // Клетка короля заданного цвета (-1, если короля нет)
+    int kingSquare(Color color) const {
+        Bitboard king = pieces[colorIndex(color)][int(PieceType::KING)];
+        return king ? lsb(king) : -1;
+    }
+
+    // Установка прав на рокировку (биты KQkq) через нетронутых короля и ладей;
+    // пешки на стартовых горизонталях также помечаются нетронутыми.
+    // false - для части прав король или ладья не на исходных клетках (они пропущены)
+    bool setCastlingRights(int rights);
+
+    // Расстановка возможна в партии: не больше 16 фигур у каждой стороны, пешки не
+    // на крайних горизонталях, сторона, которая не ходит, не под шахом
+    bool isPlausibleSetup() const;
+
+    // Клетка взятия на проходе согласуется с позицией: горизонталь по очереди хода,
+    // клетка и поле, откуда пришла пешка, пусты, сама пешка соперника перед ней
+    bool isEnPassantPlausible(int sq) const;
+
+    // Вклад взятия на проходе в ключ: учитывается, только если пешке есть чем взять
+    uint64_t enPassantKey() const;
+
+    // Полный пересчет ключа Зобриста
+    uint64_t computeKey() const;
+
+    // Полный пересчет ключа пешек
+    uint64_t computePawnKey() const;
+
+    // Все фигуры обоих цветов, атакующие клетку sq при заданной занятости
+    Bitboard attackersTo(int sq, Bitboard occupied) const {
+        const Bitboard(&w)[6] = pieces[0];
+        const Bitboard(&b)[6] = pieces[1];
+        Bitboard rooks = w[int(PieceType::ROOK)] | w[int(PieceType::QUEEN)]
+                       | b[int(PieceType::ROOK)] | b[int(PieceType::QUEEN)];
+        Bitboard bishops = w[int(PieceType::BISHOP)] | w[int(PieceType::QUEEN)]
+                         | b[int(PieceType::BISHOP)] | b[int(PieceType::QUEEN)];
+        return (PawnAttacks.sq[1][sq] & w[int(PieceType::PAWN)])
+             | (PawnAttacks.sq[0][sq] & b[int(PieceType::PAWN)])
+             | (KnightAttacks.sq[sq] & (w[int(PieceType::KNIGHT)] | b[int(PieceType::KNIGHT)]))
+             | (KingAttacks.sq[sq] & (w[int(PieceType::KING)] | b[int(PieceType::KING)]))
+             | (rookAttacks(sq, occupied) & rooks)
+             | (bishopAttacks(sq, occupied) & bishops);
+    }
+
+    // Клетки, куда может пойти фигура с клетки sq (без учета шаха своему королю)
+    Bitboard pseudoTargets(int sq) const;
+
+    // Фигуры цвета us, связанные с собственным королем
+    Bitboard pinnedPieces(int us, int kingSq) const;
+
+    // Маски шаха и связок текущего игрока считаются каждая при первом запросе после
+    // хода (ход и отмена только сбрасывают checkInfoValid): isInCheck платит только
+    // за шахующие фигуры, связки добавляются при генерации ходов, повторные запросы
+    // ничего не стоят. Из-за кэша одну доску нельзя читать из нескольких потоков:
+    // у каждого своя копия
+    static const uint8_t CHECKERS_VALID = 1;
+    static const uint8_t PINS_VALID = 2;
+
+    Bitboard currentCheckers() const {
+        if (!(checkInfoValid & CHECKERS_VALID)) {
+            int kingSq = kingSquare(currentPlayer);
+            checkersBB = kingSq >= 0 ? attackersTo(kingSq, occupiedBB) & colorBB[colorIndex(currentPlayer) ^ 1] : 0;
+            checkInfoValid |= CHECKERS_VALID;
+        }
+        return checkersBB;
+    }
+
+    Bitboard currentPinned() const {
+        if (!(checkInfoValid & PINS_VALID)) {
+            int kingSq = kingSquare(currentPlayer);
+            pinnedBB = kingSq >= 0 ? pinnedPieces(colorIndex(currentPlayer), kingSq) : 0;
+            checkInfoValid |= PINS_VALID;
+        }
+        return pinnedBB;
+    }
+
+    // Шахующие и связанные фигуры цвета color с королем на kingSq: для текущего
+    // игрока берутся из кэша, для другого цвета считаются заново
+    void checkInfo(Color color, int kingSq, Bitboard& checkers, Bitboard& pinned) const {
+        int us = colorIndex(color);
+        if (color == currentPlayer) {
+            if (!(checkInfoValid & CHECKERS_VALID)) {
+                checkersBB = attackersTo(kingSq, occupiedBB) & colorBB[us ^ 1];
+            }
+            if (!(checkInfoValid & PINS_VALID)) {
+                pinnedBB = pinnedPieces(us, kingSq);
+            }
+            checkInfoValid = CHECKERS_VALID | PINS_VALID;
+            checkers = checkersBB;
+            pinned = pinnedBB;
+            return;
+        }
+        checkers = attackersTo(kingSq, occupiedBB) & colorBB[us ^ 1];
+        pinned = pinnedPieces(us, kingSq);
+    }
+
+    // Атаки дальнобойной фигуры с клетки sq при текущей занятости
+    Bitboard sliderAttacks(int sq) const {
+        switch (mailbox[sq]) {
+        case PieceType::QUEEN: return queenAttacks(sq, occupiedBB);
+        case PieceType::ROOK: return rookAttacks(sq, occupiedBB);
+        default: return bishopAttacks(sq, occupiedBB);
+        }
+    }
+
+    // Предпоследняя горизонталь пешек цвета us: с нее пешка ходит с превращением
+    static Bitboard promotionRank(int us) {
+        return us == 0 ? (RANK_1_BB << 48) : (RANK_1_BB << 8);
+    }
+
+    // Ходы пешек без превращений: непривязанные пешки обрабатываются сразу всем битбордом
+    void generatePawnMoves(int us, GenType type, Bitboard mask, Bitboard pinned, int kingSq, MoveList& list) const;
+
+    // Превращения; checkMask - клетки, допустимые при шахе
+    void generatePromotions(int us, Bitboard checkMask, Bitboard pinned, int kingSq, MoveList& list) const;
+
+    // Взятия на проходе: проверяются снятием обеих пешек с доски
+    void generateEnPassant(int us, Bitboard checkMask, int kingSq, MoveList& list) const;
+
+    // Есть ли нетронутая ладья с пустыми клетками между ней и королем цвета us
+    bool castlingPathFree(int us) const {
+        Bitboard rooks = unmovedBB & pieces[us][int(PieceType::ROOK)];
+        Bitboard shortPath = us == 0 ? 0x60ULL : 0x60ULL << 56;
+        Bitboard longPath = us == 0 ? 0x0EULL : 0x0EULL << 56;
+        return ((rooks & (shortPath << 1)) && !(occupiedBB & shortPath))
+            || ((rooks & (longPath >> 1)) && !(occupiedBB & longPath));
+    }
+
+    // Рокировки (король не под шахом): путь свободен и не атакован
+    void generateCastling(int us, MoveList& list) const;
+
+    // Выполнение и отмена превращения, взятия на проходе и рокировки
+    void makeSpecialMove(Move move, int us);
+    void unmakeSpecialMove(const UndoInfo& undo);
+
+    // Генерация допустимых ходов цвета color с помощью масок связок и шахов
+    void generateLegal(Color color, GenType type, MoveList& list) const;
+
+    // Есть ли у цвета color хотя бы один допустимый ход (без построения списка:
+    // поиск прекращается на первом найденном ходе)
+    bool hasLegalMoves(Color color) const;
+
+    // Очистка доски
+    void clearBoard();
+
+    // Инициализация доски в зависимости от уровня сложности
+    void initializeBoard();
+
+public:
+    // Конструктор с установкой уровня сложности
+    explicit ChessBoard(int diff = 3);
+
+    // Загрузка позиции из FEN. При ошибке доска возвращается в начальную позицию
+    bool loadFen(const std::string& fen);
+
+    // Запись текущей позиции в FEN
+    std::string toFen() const;
+
+    // Упаковка позиции в 32 байта (false - на доске больше 32 фигур, позиция
+    // не упаковывается) и обратная загрузка (false - некорректные данные,
+    // доска при этом возвращается в начальную позицию)
+    bool pack(PackedPosition& packed) const;
+    bool unpack(const PackedPosition& packed);
+
+    // Номер полухода от начала партии
+    int gamePly() const {
+        return startPly + int(history.size());
+    }
+
+    // Проверка, находится ли позиция в пределах доски
+    static bool isPositionValid(const Position& pos) {
+        return pos.x >= 0 && pos.x < 8 && pos.y >= 0 && pos.y < 8;
+    }
+
+    // Фигура на клетке доски
+    Piece pieceAt(const Position& pos) const {
+        return pieceAt(makeSquare(pos.x, pos.y));
+    }
+
+    // Тип фигуры на клетке 0-63 (NONE для пустой)
+    PieceType typeAt(int sq) const {
+        return mailbox[sq];
+    }
+
+    // Битборд фигур заданного цвета и типа
+    Bitboard piecesOf(Color color, PieceType type) const {
+        return pieces[colorIndex(color)][int(type)];
+    }
+
+    // Все фигуры цвета и все занятые клетки
+    Bitboard piecesOf(Color color) const {
+        return colorBB[colorIndex(color)];
+    }
+
+    Bitboard occupied() const {
+        return occupiedBB;
+    }
+
+    Color sideToMove() const {
+        return currentPlayer;
+    }
+
+    bool isGameOver() const {
+        return gameOver;
+    }
+
+    int getDifficulty() const {
+        return difficulty;
+    }
+
+    // Допустимый ход текущего игрока с клетки from на клетку to (MOVE_NONE, если
+    // такого нет); пешка, дошедшая до последней горизонтали, превращается в promotion
+    Move findMove(int from, int to, PieceType promotion = PieceType::QUEEN) const;
+
+    // Проверка правильности хода по всем правилам, включая рокировку и взятие на проходе
+    bool isMoveValid(const Position& from, const Position& to) const;
+
+    // Есть ли ход среди допустимых ходов текущего игрока
+    bool isLegal(Move move) const;
+
+    // Проверка, находится ли король под шахом (для текущего игрока - ответ из
+    // кэша масок шаха, который заполняется один раз на позицию)
+    bool isInCheck(Color color) const;
+
+    // Фигуры противника, объявившие шах текущему игроку
+    Bitboard checkers() const {
+        return currentCheckers();
+    }
+
+    // Проверка на мат: шах и нет ни одного допустимого хода
+    bool isCheckmate(Color color) const;
+
+    // Проверка на пат: шаха нет, но и ходить некуда
+    bool isStalemate(Color color) const;
+
+    // Генерация допустимых ходов текущего игрока. Ходы добавляются в конец списка,
+    // поэтому взятия и тихие ходы можно получать отдельными этапами
+    void generateMoves(MoveList& list, GenType type = GenType::ALL) const {
+        generateLegal(currentPlayer, type, list);
+    }
+
+    // Разбор хода в координатной нотации ("e2e4") среди допустимых ходов
+    // текущего игрока (MOVE_NONE, если такого хода нет)
+    Move parseMove(const std::string& text) const;
+
+    // Разбор хода в краткой алгебраической нотации ("Nf3", "exd5", "Qh4+");
+    // MOVE_NONE, если ход недопустим или неоднозначен
+    Move parseSan(std::string_view san) const;
+
+    // Выполнение хода с проверкой правил; после хода определяется конец партии:
+    // мат, пат, правило 50 ходов или троекратное повторение
+    bool makeMove(const Position& from, const Position& to, PieceType promotion = PieceType::QUEEN);
+
+    // Выполнение заведомо допустимого хода (из generateMoves, parseMove, findMove)
+    // за O(1) с записью в стек отмены. Допустимость не проверяется: это путь перебора
+    void makeMove(Move move);
+
+    // Ход из недоверенного источника (например, архива) можно передать в makeMove(Move):
+    // на клетке "откуда" фигура стороны, которая ходит, на клетке "куда" - не своя
+    // фигура и не король, особый ход делается нужной фигурой. Шахи не проверяются
+    bool isMoveWellFormed(Move move) const;
+
+    // Взятие (в том числе на проходе)
+    bool isCapture(Move move) const {
+        return mailbox[moveTo(move)] != PieceType::NONE || moveType(move) == MOVE_EN_PASSANT;
+    }
+
+    // Отмена последнего хода из стека
+    void unmakeMove();
+
+    // Ключ Зобриста текущей позиции
+    uint64_t hashKey() const {
+        return key;
+    }
+
+    // Сколько раз текущая позиция (с той же очередью хода) уже встречалась
+    // в партии после последнего взятия или хода пешки; 2 - троекратное повторение
+    int repetitionCount() const;
+
+    // Полуходы без взятий и ходов пешек
+    int halfmoveClock() const {
+        return rule50;
+    }
+
+    // Ничья по правилу 50 ходов или троекратному повторению
+    bool isDrawByRule() const {
+        return rule50 >= 100 || repetitionCount() >= 2;
+    }
+
+    // Мат невозможен ни при каких ходах: только короли и не более одной легкой
+    // фигуры либо только слоны, все на полях одного цвета
+    bool isInsufficientMaterial() const;
+
+    // Права на рокировку (биты KQkq), выводятся из Piece::hasMoved короля и ладей
+    int castlingRights() const;
+
+    // Клетка взятия на проходе, если его может сделать хотя бы одна пешка (-1, если нет)
+    int enPassantTarget() const;
+
+    // Ключ расположения пешек: не зависит от остальных фигур и очереди хода
+    uint64_t pawnHashKey() const {
+        return pawnKey;
+    }
+
+    // Инкрементальные материал и таблицы фигура-клетка (перевес белых)
+    int psqMidgame() const {
+        return psqMg;
+    }
+
+    int psqEndgame() const {
+        return psqEg;
+    }
+
+    // Стадия партии: PHASE_MAX - все фигуры на доске, 0 - только короли и пешки
+    int gamePhase() const {
+        return phase < PHASE_MAX ? phase : PHASE_MAX;
+    }
+};
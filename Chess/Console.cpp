@@ -0,0 +1,103 @@
+#include "Console.h"
+
+#include <iostream>
+
+#if defined(_WIN32)
+#include <windows.h>
+#ifndef ENABLE_VIRTUAL_TERMINAL_PROCESSING
+#define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004
+#endif
+#endif
+
+namespace {
+
+// Символы фигур: KING, QUEEN, ROOK, BISHOP, KNIGHT, PAWN, NONE
+const char PieceChars[2][7] = {
+    { 'K', 'Q', 'R', 'B', 'N', 'P', '.' },
+    { 'k', 'q', 'r', 'b', 'n', 'p', '.' },
+};
+
+const char* FILE_LABELS = "    a b c d e f g h\n";
+const char* BORDER = "   -----------------\n";
+
+// Примерный размер кадра: 18 строк и смены цвета
+const size_t FRAME_RESERVE = 1024;
+
+} // namespace
+
+void initConsole() {
+#if defined(_WIN32)
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (GetConsoleMode(out, &mode)) {
+        SetConsoleMode(out, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    }
+#endif
+}
+
+const char* ansiColor(int color) {
+    switch (color) {
+    case COLOR_BLUE: return "\x1b[94m";
+    case COLOR_RED: return "\x1b[91m";
+    case COLOR_YELLOW: return "\x1b[93m";
+    case COLOR_WHITE: return "\x1b[97m";
+    default: return "\x1b[0m";
+    }
+}
+
+void setConsoleColor(int color) {
+    std::cout << ansiColor(color);
+}
+
+void resetConsoleColor() {
+    setConsoleColor(COLOR_DEFAULT);
+}
+
+void renderBoard(const ChessBoard& board, std::string& frame) {
+    frame.reserve(frame.size() + FRAME_RESERVE);
+    frame += ansiColor(COLOR_DEFAULT);
+    frame += FILE_LABELS;
+    frame += BORDER;
+
+    Bitboard white = 0;
+    Bitboard black = 0;
+    for (int t = 0; t < 6; ++t) {
+        white |= board.piecesOf(Color::WHITE, PieceType(t));
+        black |= board.piecesOf(Color::BLACK, PieceType(t));
+    }
+
+    // Строки сверху вниз (от 8 до 1); цвет: белые - белым, черные - синим
+    int current = COLOR_DEFAULT;
+    for (int y = 7; y >= 0; --y) {
+        frame += char('1' + y);
+        frame += " | ";
+
+        for (int x = 0; x < 8; ++x) {
+            int sq = makeSquare(x, y);
+            bool isBlack = (black & squareBB(sq)) != 0;
+            int color = (white & squareBB(sq)) ? COLOR_WHITE : isBlack ? COLOR_BLUE : COLOR_DEFAULT;
+            if (color != current) {
+                frame += ansiColor(color);
+                current = color;
+            }
+            frame += PieceChars[isBlack ? 1 : 0][int(board.typeAt(sq))];
+            frame += ' ';
+        }
+
+        if (current != COLOR_DEFAULT) {
+            frame += ansiColor(COLOR_DEFAULT);
+            current = COLOR_DEFAULT;
+        }
+        frame += "| ";
+        frame += char('1' + y);
+        frame += '\n';
+    }
+
+    frame += BORDER;
+    frame += FILE_LABELS;
+    frame += '\n';
+}
+
+void writeFrame(const std::string& frame) {
+    std::cout.write(frame.data(), std::streamsize(frame.size())).flush();
+}
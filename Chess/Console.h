@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+#include "ChessBoard.h"
+
+// Цвета консоли в нумерации палитры Windows, которой исторически пользуется игра
+const int COLOR_DEFAULT = 7;    // Серый
+const int COLOR_BLUE = 9;
+const int COLOR_RED = 12;
+const int COLOR_YELLOW = 14;
+const int COLOR_WHITE = 15;
+
+// Подготовка консоли к escape-последовательностям ANSI
+// (в Windows включает режим виртуального терминала, в остальных ОС ничего не делает)
+void initConsole();
+
+// Escape-последовательность ANSI для цвета из палитры выше
+const char* ansiColor(int color);
+
+// Смена цвета последующего вывода в cout
+void setConsoleColor(int color);
+
+void resetConsoleColor();
+
+// Кадр с доской целиком: метки, клетки и цвета собираются в frame (дописываются
+// в конец), цвет меняется только там, где он отличается от предыдущего символа
+void renderBoard(const ChessBoard& board, std::string& frame);
+
+// Вывод готового кадра одним вызовом
+void writeFrame(const std::string& frame);
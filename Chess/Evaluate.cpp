@@ -0,0 +1,241 @@
+#include "Evaluate.h"
+
+namespace {
+
+// Штрафы и бонусы пешечной структуры (миттельшпиль, эндшпиль)
+const int DOUBLED_MG = 10, DOUBLED_EG = 20;
+const int ISOLATED_MG = 10, ISOLATED_EG = 15;
+
+// Бонус проходной пешке по горизонтали, считая от своего края доски
+const int PassedMg[8] = { 0, 5, 10, 15, 25, 40, 60, 0 };
+const int PassedEg[8] = { 0, 10, 15, 25, 45, 70, 110, 0 };
+
+// Кандидат в проходные: путь по своей вертикали свободен от пешек противника,
+// а своих пешек-помощников на соседних вертикалях не меньше, чем сторожей
+const int CandidateMg[8] = { 0, 2, 4, 7, 12, 20, 0, 0 };
+const int CandidateEg[8] = { 0, 5, 8, 12, 20, 35, 0, 0 };
+
+// Безопасность короля: пешки щита и вес атакующих фигур
+const int SHIELD_BONUS = 10;
+const int AttackWeight[6] = { 0, 5, 3, 2, 2, 0 };   // KING, QUEEN, ROOK, BISHOP, KNIGHT, PAWN
+const int MAX_ATTACK_UNITS = 20;
+
+// Маски для пешечной структуры
+struct PawnMasks {
+    Bitboard file[8];              // Вертикаль
+    Bitboard adjacentFiles[8];     // Соседние вертикали
+    Bitboard passed[2][64];        // Клетки впереди на своей и соседних вертикалях
+};
+
+constexpr PawnMasks makePawnMasks() {
+    PawnMasks m = {};
+    for (int x = 0; x < 8; ++x) {
+        m.file[x] = FILE_A_BB << x;
+    }
+    for (int x = 0; x < 8; ++x) {
+        m.adjacentFiles[x] = (x > 0 ? m.file[x - 1] : 0) | (x < 7 ? m.file[x + 1] : 0);
+    }
+    for (int sq = 0; sq < 64; ++sq) {
+        int x = sq % 8;
+        int y = sq / 8;
+        Bitboard files = m.file[x] | m.adjacentFiles[x];
+        for (int r = 0; r < 8; ++r) {
+            Bitboard rank = RANK_1_BB << (8 * r);
+            if (r > y) {
+                m.passed[0][sq] |= files & rank;
+            }
+            if (r < y) {
+                m.passed[1][sq] |= files & rank;
+            }
+        }
+    }
+    return m;
+}
+
+constexpr PawnMasks Masks = makePawnMasks();
+
+// Штраф за атаки на зону короля растет квадратично с их суммарным весом
+constexpr int attackPenalty(int units) {
+    return units * units * 2 < 500 ? units * units * 2 : 500;
+}
+
+// Байт битборда, развернутый в 8 масок по 16 бит (0 или -1)
+struct ByteMaskTable {
+    alignas(16) int16_t mask[256][8];
+};
+
+constexpr ByteMaskTable makeByteMasks() {
+    ByteMaskTable t = {};
+    for (int b = 0; b < 256; ++b) {
+        for (int i = 0; i < 8; ++i) {
+            t.mask[b][i] = int16_t((b >> i) & 1 ? -1 : 0);
+        }
+    }
+    return t;
+}
+
+constexpr ByteMaskTable ByteMasks = makeByteMasks();
+
+// Сумма значений таблицы по клеткам битборда без ветвлений: каждая горизонталь -
+// 8 значений по 16 бит под маской из таблицы, что компилятор сводит к векторным
+// AND и сложениям (SSE2, AVX2)
+inline int maskedSum(Bitboard bb, const int16_t* table) {
+    int sum = 0;
+    for (int rank = 0; rank < 8; ++rank) {
+        const int16_t* mask = ByteMasks.mask[(bb >> (8 * rank)) & 0xFF];
+        const int16_t* row = table + 8 * rank;
+        for (int i = 0; i < 8; ++i) {
+            sum += row[i] & mask[i];
+        }
+    }
+    return sum;
+}
+
+} // namespace
+
+PawnEval evaluatePawns(const ChessBoard& board) {
+    PawnEval result;
+    Bitboard pawns[2] = {
+        board.piecesOf(Color::WHITE, PieceType::PAWN),
+        board.piecesOf(Color::BLACK, PieceType::PAWN),
+    };
+
+    for (int c = 0; c < 2; ++c) {
+        int sign = (c == 0) ? 1 : -1;
+        Bitboard own = pawns[c];
+
+        for (int x = 0; x < 8; ++x) {
+            int count = popCount(own & Masks.file[x]);
+            if (count == 0) {
+                continue;
+            }
+            if (count > 1) {
+                result.mg -= sign * DOUBLED_MG * (count - 1);
+                result.eg -= sign * DOUBLED_EG * (count - 1);
+            }
+            if (!(own & Masks.adjacentFiles[x])) {
+                result.mg -= sign * ISOLATED_MG * count;
+                result.eg -= sign * ISOLATED_EG * count;
+            }
+        }
+
+        Bitboard b = own;
+        while (b) {
+            int sq = popLsb(b);
+            int rank = (c == 0) ? rankOf(sq) : 7 - rankOf(sq);
+            Bitboard front = Masks.passed[c][sq];
+            if (!(front & pawns[c ^ 1])) {
+                result.passed[c] |= squareBB(sq);
+                result.mg += sign * PassedMg[rank];
+                result.eg += sign * PassedEg[rank];
+                continue;
+            }
+            if (front & Masks.file[fileOf(sq)] & pawns[c ^ 1]) {
+                continue;
+            }
+            Bitboard sentries = front & pawns[c ^ 1];
+            Bitboard helpers = Masks.adjacentFiles[fileOf(sq)] & ~front & own;
+            if (popCount(helpers) >= popCount(sentries)) {
+                result.candidates[c] |= squareBB(sq);
+                result.mg += sign * CandidateMg[rank];
+                result.eg += sign * CandidateEg[rank];
+            }
+        }
+    }
+    return result;
+}
+
+PawnEval probePawns(const ChessBoard& board, PawnTable* pawns) {
+    if (!pawns || !pawns->enabled()) {
+        return evaluatePawns(board);
+    }
+    uint64_t key = board.pawnHashKey();
+    if (const PawnEval* cached = pawns->probe(key)) {
+        return *cached;
+    }
+    PawnEval result = evaluatePawns(board);
+    pawns->store(key, result);
+    return result;
+}
+
+int kingSafety(const ChessBoard& board, Color color) {
+    Color enemy = (color == Color::WHITE) ? Color::BLACK : Color::WHITE;
+    Bitboard king = board.piecesOf(color, PieceType::KING);
+    if (!king) {
+        return 0;
+    }
+    int kingSq = lsb(king);
+    int score = 0;
+
+    // Пешечный щит: свои пешки на двух горизонталях перед королем на первых двух рядах
+    int relativeRank = (color == Color::WHITE) ? rankOf(kingSq) : 7 - rankOf(kingSq);
+    if (relativeRank <= 1) {
+        Bitboard files = Masks.file[fileOf(kingSq)] | Masks.adjacentFiles[fileOf(kingSq)];
+        Bitboard front = Masks.passed[color == Color::WHITE ? 0 : 1][kingSq] & files;
+        Bitboard nearRanks = (color == Color::WHITE)
+            ? (RANK_1_BB << (8 * (rankOf(kingSq) + 1))) | (RANK_1_BB << (8 * (rankOf(kingSq) + 2)))
+            : (RANK_1_BB << (8 * (rankOf(kingSq) - 1))) | (RANK_1_BB << (8 * (rankOf(kingSq) - 2)));
+        score += SHIELD_BONUS * popCount(front & nearRanks & board.piecesOf(color, PieceType::PAWN));
+    }
+
+    // Атаки фигур противника на клетки вокруг короля
+    Bitboard zone = KingAttacks.sq[kingSq] | king;
+    Bitboard occupied = board.occupied();
+    int attackers = 0;
+    int units = 0;
+    for (int t = int(PieceType::QUEEN); t <= int(PieceType::KNIGHT); ++t) {
+        Bitboard b = board.piecesOf(enemy, PieceType(t));
+        while (b) {
+            int sq = popLsb(b);
+            Bitboard attacks = 0;
+            switch (PieceType(t)) {
+            case PieceType::QUEEN: attacks = queenAttacks(sq, occupied); break;
+            case PieceType::ROOK: attacks = rookAttacks(sq, occupied); break;
+            case PieceType::BISHOP: attacks = bishopAttacks(sq, occupied); break;
+            default: attacks = KnightAttacks.sq[sq]; break;
+            }
+            if (attacks & zone) {
+                ++attackers;
+                units += AttackWeight[t] * popCount(attacks & zone);
+            }
+        }
+    }
+
+    // Одна атакующая фигура королю обычно не опасна
+    if (attackers >= 2) {
+        score -= attackPenalty(units < MAX_ATTACK_UNITS ? units : MAX_ATTACK_UNITS);
+    }
+    return score;
+}
+
+PsqScore computePsq(const ChessBoard& board) {
+    PsqScore result;
+    for (int c = 0; c < 2; ++c) {
+        Color color = (c == 0) ? Color::WHITE : Color::BLACK;
+        for (int t = 0; t < 6; ++t) {
+            Bitboard b = board.piecesOf(color, PieceType(t));
+            if (!b) {
+                continue;
+            }
+            result.mg += maskedSum(b, Psqt.mg[c][t]);
+            result.eg += maskedSum(b, Psqt.eg[c][t]);
+            result.phase += PhaseWeight[t] * popCount(b);
+        }
+    }
+    return result;
+}
+
+int evaluate(const ChessBoard& board, PawnTable* pawns) {
+    int mg = board.psqMidgame();
+    int eg = board.psqEndgame();
+
+    PawnEval structure = probePawns(board, pawns);
+    mg += structure.mg;
+    eg += structure.eg;
+
+    mg += kingSafety(board, Color::WHITE) - kingSafety(board, Color::BLACK);
+
+    int phase = board.gamePhase();
+    int score = (mg * phase + eg * (PHASE_MAX - phase)) / PHASE_MAX;
+    return board.sideToMove() == Color::WHITE ? score : -score;
+}
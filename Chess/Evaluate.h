@@ -0,0 +1,30 @@
+#pragma once
+
+#include "ChessBoard.h"
+#include "PawnTable.h"
+
+// Материал и таблицы фигура-клетка, посчитанные заново
+struct PsqScore {
+    int mg = 0;
+    int eg = 0;
+    int phase = 0;
+};
+
+// Статическая оценка позиции с точки зрения стороны, которой ходить:
+// материал и таблицы фигура-клетка (ведутся доской инкрементально), пешечная
+// структура и безопасность короля; миттельшпиль и эндшпиль смешиваются по стадии.
+// С таблицей pawns оценка пешечной структуры берется из пешечного хеша
+int evaluate(const ChessBoard& board, PawnTable* pawns = nullptr);
+
+// Сдвоенные, изолированные, проходные и кандидаты в проходные пешки
+PawnEval evaluatePawns(const ChessBoard& board);
+
+// Оценка пешечной структуры через пешечный хеш (без таблицы - расчет заново)
+PawnEval probePawns(const ChessBoard& board, PawnTable* pawns);
+
+// Безопасность короля цвета color: пешечный щит и атаки на зону короля (миттельшпиль)
+int kingSafety(const ChessBoard& board, Color color);
+
+// Полный пересчет материала и таблиц без ветвлений по фигурам: запасной путь
+// и проверка инкрементальных счетчиков доски
+PsqScore computePsq(const ChessBoard& board);
@@ -0,0 +1,108 @@
+#include "GameArchive.h"
+
+ArchiveWriter::~ArchiveWriter() {
+    close();
+}
+
+void ArchiveWriter::write(const void* data, size_t size) {
+    if (size && fwrite(data, 1, size, file) != size) {
+        failed = true;
+    }
+}
+
+bool ArchiveWriter::open(const std::string& path) {
+    close();
+    file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    // Заголовок пока пустой: число партий и индекс известны только в конце
+    ArchiveHeader header = {};
+    write(&header, sizeof(header));
+    offset = sizeof(header);
+    index.clear();
+    failed = false;
+    return !failed;
+}
+
+bool ArchiveWriter::close() {
+    if (!file) {
+        return !failed;
+    }
+
+    write(index.data(), index.size() * sizeof(uint64_t));
+
+    ArchiveHeader header = {};
+    memcpy(header.magic, ARCHIVE_MAGIC, sizeof(header.magic));
+    header.version = ARCHIVE_VERSION;
+    header.gameCount = index.size();
+    header.indexOffset = offset;
+    if (fseek(file, 0, SEEK_SET) != 0) {
+        failed = true;
+    }
+    write(&header, sizeof(header));
+
+    if (fclose(file) != 0) {
+        failed = true;
+    }
+    file = nullptr;
+    return !failed;
+}
+
+void ArchiveWriter::encodeGame(std::string& out, const PackedPosition& start, const Move* moves, int count, GameResult result) {
+    if (count > ARCHIVE_MAX_MOVES) {
+        count = ARCHIVE_MAX_MOVES;
+    }
+    ArchiveGameHeader header = {};
+    header.start = start;
+    header.moveCount = uint16_t(count);
+    header.result = result;
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (count > 0) {
+        out.append(reinterpret_cast<const char*>(moves), sizeof(Move) * size_t(count));
+    }
+}
+
+void ArchiveWriter::addGame(const PackedPosition& start, const Move* moves, int count, GameResult result) {
+    std::string record;
+    encodeGame(record, start, moves, count, result);
+    addEncoded(record);
+}
+
+void ArchiveWriter::addEncoded(const std::string& records) {
+    // Смещения партий восстанавливаются по числу ходов в их заголовках
+    size_t pos = 0;
+    while (pos + sizeof(ArchiveGameHeader) <= records.size()) {
+        index.push_back(offset + pos);
+        uint16_t count;
+        memcpy(&count, records.data() + pos + offsetof(ArchiveGameHeader, moveCount), sizeof(count));
+        pos += sizeof(ArchiveGameHeader) + sizeof(Move) * count;
+    }
+    write(records.data(), records.size());
+    offset += records.size();
+}
+
+bool ArchiveReader::open(const std::string& path) {
+    games = 0;
+    indexData = nullptr;
+    recordsEnd = 0;
+    if (!file.open(path) || file.size() < sizeof(ArchiveHeader)) {
+        return false;
+    }
+
+    ArchiveHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, ARCHIVE_MAGIC, sizeof(header.magic)) != 0
+        || header.version != ARCHIVE_VERSION
+        || header.indexOffset > file.size()
+        || header.gameCount > (file.size() - header.indexOffset) / sizeof(uint64_t)) {
+        file.close();
+        return false;
+    }
+
+    games = header.gameCount;
+    indexData = file.data() + header.indexOffset;
+    recordsEnd = header.indexOffset;
+    return true;
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "Move.h"
+#include "PackedPosition.h"
+
+// Итог партии в архиве
+enum class GameResult : uint8_t { UNKNOWN, WHITE_WINS, BLACK_WINS, DRAW };
+
+// Двоичный архив партий. Все числа записываются в порядке байтов little-endian
+// (как в памяти x86 и ARM), поэтому структуры читаются прямо из отображения:
+//   заголовок ArchiveHeader
+//   партии подряд: ArchiveGameHeader (начальная позиция, число ходов, итог)
+//                  и ходы по 2 байта
+//   индекс: смещение каждой партии от начала файла (8 байт на партию)
+// Индекс позволяет открыть любую партию, не разбирая предыдущие
+struct ArchiveHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t gameCount;
+    uint64_t indexOffset;
+};
+
+struct ArchiveGameHeader {
+    PackedPosition start;
+    uint16_t moveCount;
+    GameResult result;
+    uint8_t reserved[5];
+};
+
+static_assert(sizeof(ArchiveHeader) == 32, "ArchiveHeader must stay 32 bytes");
+static_assert(sizeof(ArchiveGameHeader) == 40, "ArchiveGameHeader must stay 40 bytes");
+
+const char ARCHIVE_MAGIC[8] = { 'C', 'H', 'S', 'A', 'R', 'C', 'H', '\0' };
+const uint32_t ARCHIVE_VERSION = 1;
+const int ARCHIVE_MAX_MOVES = 65535;
+
+// Запись архива. Партии пишутся сразу в файл, индекс - при закрытии
+class ArchiveWriter {
+private:
+    FILE* file = nullptr;
+    uint64_t offset = 0;              // Смещение следующей партии
+    std::vector<uint64_t> index;
+    bool failed = false;
+
+    void write(const void* data, size_t size);
+
+public:
+    ArchiveWriter() = default;
+    ~ArchiveWriter();
+
+    ArchiveWriter(const ArchiveWriter&) = delete;
+    ArchiveWriter& operator=(const ArchiveWriter&) = delete;
+
+    bool open(const std::string& path);
+
+    // Завершение архива: запись индекса и заголовка; false при ошибке записи
+    bool close();
+
+    void addGame(const PackedPosition& start, const Move* moves, int count, GameResult result);
+
+    // Добавление партий, заранее закодированных encodeGame (например, в разных потоках)
+    void addEncoded(const std::string& records);
+
+    // Кодирование партии в конец буфера в формате архива
+    static void encodeGame(std::string& out, const PackedPosition& start, const Move* moves, int count, GameResult result);
+
+    uint64_t gameCount() const {
+        return index.size();
+    }
+};
+
+// Партия архива: вид на отображенный файл, ходы читаются по одному
+class ArchiveGame {
+private:
+    const char* record;
+
+public:
+    ArchiveGame() : record(nullptr) {
+    }
+
+    explicit ArchiveGame(const char* data) : record(data) {
+    }
+
+    ArchiveGameHeader header() const {
+        ArchiveGameHeader h;
+        memcpy(&h, record, sizeof(h));
+        return h;
+    }
+
+    PackedPosition start() const {
+        return header().start;
+    }
+
+    int moveCount() const {
+        uint16_t count;
+        memcpy(&count, record + offsetof(ArchiveGameHeader, moveCount), sizeof(count));
+        return count;
+    }
+
+    GameResult result() const {
+        return GameResult(record[offsetof(ArchiveGameHeader, result)]);
+    }
+
+    Move move(int i) const {
+        Move m;
+        memcpy(&m, record + sizeof(ArchiveGameHeader) + 2 * size_t(i), sizeof(m));
+        return m;
+    }
+};
+
+// Чтение архива через отображение в память
+class ArchiveReader {
+private:
+    MappedFile file;
+    uint64_t games = 0;
+    const char* indexData = nullptr;
+    uint64_t recordsEnd = 0;          // Партии лежат между заголовком и индексом
+
+public:
+    // false, если файл не открылся или не является архивом
+    bool open(const std::string& path);
+
+    uint64_t gameCount() const {
+        return games;
+    }
+
+    // Партия i (i < gameCount()); false - смещение из индекса или число ходов
+    // выводят запись за пределы партий файла
+    bool game(uint64_t i, ArchiveGame& out) const {
+        uint64_t offset;
+        memcpy(&offset, indexData + 8 * i, sizeof(offset));
+        if (offset < sizeof(ArchiveHeader) || offset > recordsEnd
+            || recordsEnd - offset < sizeof(ArchiveGameHeader)) {
+            return false;
+        }
+        ArchiveGame game(file.data() + offset);
+        if (uint64_t(game.moveCount()) * 2 > recordsEnd - offset - sizeof(ArchiveGameHeader)) {
+            return false;
+        }
+        out = game;
+        return true;
+    }
+
+    size_t sizeBytes() const {
+        return file.size();
+    }
+};
@@ -0,0 +1,395 @@
+// Нагрузочный клиент сервера партий (только Linux).
+//
+//   loadgen [-p порт | -u путь] [-c N] [-s N] [-m 1|2|3] [-T секунды] [-l N] [--seed число]
+//
+// Открывает -c соединений и в каждом ведет -s партий уровня -m. У каждой партии своя
+// доска клиента: ход выбирается случайно среди допустимых и посылается серверу,
+// следующий ход партии - после ответа. Закончившаяся партия (мат, ничья или -l
+// полуходов) закрывается и сразу заменяется новой. Через -T секунд выводятся ходы в
+// секунду, медиана и 99-й процентиль задержки хода (от отправки запроса до ответа)
+// и число одновременных партий на ядро машины
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "ChessBoard.h"
+#include "ServerProtocol.h"
+
+using namespace std;
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+struct Options {
+    int port = DEFAULT_SERVER_PORT;
+    string unixPath;
+    int connections = 4;
+    int sessions = 250;           // Партий на соединение
+    int mode = 3;
+    double seconds = 10.0;
+    int maxPlies = 200;
+    uint32_t seed = 1;
+};
+
+void usage() {
+    cout << "Использование:\n"
+         << "  loadgen [-p порт | -u путь] [-c N] [-s N] [-m 1|2|3] [-T секунды] [-l N] [--seed число]\n";
+}
+
+// Партия клиента
+struct Game {
+    ChessBoard board;
+    uint64_t id = 0;
+    int plies = 0;
+    Move pending = MOVE_NONE;     // Ход, ждущий ответа
+    Clock::time_point sent;
+};
+
+struct Client {
+    int fd = -1;
+    bool writing = false;         // Ждем EPOLLOUT
+    string input;
+    string output;
+    vector<Game> games;
+    unordered_map<uint64_t, uint32_t> byId;   // Номер партии сервера -> индекс в games
+};
+
+struct Stats {
+    uint64_t moves = 0;
+    uint64_t games = 0;
+    uint64_t errors = 0;
+    vector<uint32_t> latencyUs;
+};
+
+int connectServer(const Options& options) {
+    int fd;
+    if (!options.unixPath.empty()) {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (options.unixPath.size() >= sizeof(addr.sun_path)) {
+            return -1;
+        }
+        memcpy(addr.sun_path, options.unixPath.c_str(), options.unixPath.size() + 1);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            return -1;
+        }
+    }
+    else {
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(uint16_t(options.port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            return -1;
+        }
+        int yes = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    }
+    return fd;
+}
+
+class LoadGenerator {
+private:
+    const Options& options;
+    ChessBoard setup;
+    mt19937 rng;
+    vector<Client> clients;
+    Stats stats;
+    bool measuring = true;
+    int epollFd = -1;
+
+    void newGame(Client& client, uint32_t index) {
+        Game& game = client.games[index];
+        game.board = setup;
+        game.plies = 0;
+        game.pending = MOVE_NONE;
+        client.output += "N " + to_string(options.mode) + " " + to_string(index) + "\n";
+    }
+
+    void sendMove(Client& client, Game& game) {
+        MoveList list;
+        game.board.generateMoves(list);
+        game.pending = list[int(rng() % uint32_t(list.size()))];
+        game.sent = Clock::now();
+        client.output += "M " + to_string(game.id) + " " + moveToString(game.pending) + "\n";
+    }
+
+    void endGame(Client& client, uint32_t index) {
+        Game& game = client.games[index];
+        client.output += "E " + to_string(game.id) + "\n";
+        client.byId.erase(game.id);
+        if (measuring) {
+            ++stats.games;
+        }
+        newGame(client, index);
+    }
+
+    void handleLine(Client& client, string_view line) {
+        string_view original = line;
+        string_view kind = nextField(line);
+        uint64_t id = 0;
+        bool hasId = parseNumber(nextField(line), id);
+        if (!hasId && kind != "ER") {
+            return;
+        }
+
+        if (kind == "G") {
+            uint64_t index = 0;
+            if (!parseNumber(nextField(line), index) || index >= client.games.size()) {
+                return;
+            }
+            Game& game = client.games[index];
+            game.id = id;
+            client.byId[id] = uint32_t(index);
+            sendMove(client, game);
+            return;
+        }
+
+        auto found = hasId ? client.byId.find(id) : client.byId.end();
+        if (kind == "OK" && found != client.byId.end()) {
+            uint32_t index = found->second;
+            Game& game = client.games[index];
+            if (measuring) {
+                uint64_t us = uint64_t(chrono::duration_cast<chrono::microseconds>(Clock::now() - game.sent).count());
+                stats.latencyUs.push_back(uint32_t(min<uint64_t>(us, UINT32_MAX)));
+                ++stats.moves;
+            }
+            game.board.makeMove(game.pending);
+            game.pending = MOVE_NONE;
+            ++game.plies;
+
+            string_view result = nextField(line);
+            if (result != string_view(&RESULT_ONGOING, 1) || game.plies >= options.maxPlies) {
+                endGame(client, index);
+            }
+            else {
+                sendMove(client, game);
+            }
+        }
+        else if (kind == "ER") {
+            if (stats.errors++ < 5) {
+                cerr << "Ошибка сервера: " << original << "\n";
+            }
+            // Партию с ошибкой начинаем заново; без номера (нет сессий) - соединение простаивает
+            if (found != client.byId.end()) {
+                endGame(client, found->second);
+            }
+        }
+    }
+
+    bool readClient(Client& client) {
+        char buffer[16384];
+        for (;;) {
+            ssize_t n = recv(client.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (n > 0) {
+                client.input.append(buffer, size_t(n));
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            return false;
+        }
+
+        size_t pos = 0;
+        for (;;) {
+            size_t end = client.input.find('\n', pos);
+            if (end == string::npos) {
+                break;
+            }
+            handleLine(client, string_view(client.input.data() + pos, end - pos));
+            pos = end + 1;
+        }
+        client.input.erase(0, pos);
+        return true;
+    }
+
+    void watch(Client& client, size_t index, bool writing, int op = EPOLL_CTL_MOD) {
+        epoll_event ev = {};
+        ev.events = uint32_t(EPOLLIN | EPOLLRDHUP) | (writing ? uint32_t(EPOLLOUT) : 0u);
+        ev.data.u64 = index;
+        epoll_ctl(epollFd, op, client.fd, &ev);
+        client.writing = writing;
+    }
+
+    bool flush(Client& client, size_t index) {
+        while (!client.output.empty()) {
+            ssize_t n = send(client.fd, client.output.data(), client.output.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n > 0) {
+                client.output.erase(0, size_t(n));
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                // Сервер не успевает читать: остаток уйдет по EPOLLOUT
+                if (!client.writing) {
+                    watch(client, index, true);
+                }
+                return true;
+            }
+            return false;
+        }
+        if (client.writing) {
+            watch(client, index, false);
+        }
+        return true;
+    }
+
+public:
+    explicit LoadGenerator(const Options& opts)
+        : options(opts), setup(opts.mode), rng(opts.seed), clients(size_t(opts.connections)) {
+    }
+
+    bool run() {
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd < 0) {
+            perror("epoll_create1");
+            return false;
+        }
+        for (size_t i = 0; i < clients.size(); ++i) {
+            Client& client = clients[i];
+            client.fd = connectServer(options);
+            if (client.fd < 0) {
+                perror("connect");
+                return false;
+            }
+            watch(client, i, false, EPOLL_CTL_ADD);
+
+            Game game;
+            game.board = setup;
+            client.games.resize(size_t(options.sessions), game);
+            for (uint32_t g = 0; g < uint32_t(options.sessions); ++g) {
+                newGame(client, g);
+            }
+            flush(client, i);
+        }
+        stats.latencyUs.reserve(1 << 20);
+
+        auto start = Clock::now();
+        auto deadline = start + chrono::duration_cast<Clock::duration>(chrono::duration<double>(options.seconds));
+        epoll_event events[64];
+        bool ok = true;
+        while (ok && Clock::now() < deadline) {
+            int n = epoll_wait(epollFd, events, 64, 100);
+            for (int i = 0; i < n && ok; ++i) {
+                size_t index = size_t(events[i].data.u64);
+                ok = readClient(clients[index]) && flush(clients[index], index);
+            }
+            if (n < 0 && errno != EINTR) {
+                perror("epoll_wait");
+                ok = false;
+            }
+        }
+        measuring = false;
+        double elapsed = chrono::duration<double>(Clock::now() - start).count();
+
+        for (Client& client : clients) {
+            close(client.fd);
+        }
+        close(epollFd);
+        if (!ok) {
+            cerr << "Соединение с сервером потеряно\n";
+            return false;
+        }
+        report(elapsed);
+        return true;
+    }
+
+    void report(double elapsed) {
+        auto percentile = [&](double fraction) {
+            vector<uint32_t>& values = stats.latencyUs;
+            if (values.empty()) {
+                return 0.0;
+            }
+            size_t k = min(values.size() - 1, size_t(fraction * double(values.size())));
+            nth_element(values.begin(), values.begin() + ptrdiff_t(k), values.end());
+            return double(values[k]);
+        };
+
+        int cores = max(1, int(thread::hardware_concurrency()));
+        int sessions = options.connections * options.sessions;
+        cout << fixed << setprecision(1)
+             << "Соединений: " << options.connections << ", партий одновременно: " << sessions
+             << " (уровень " << options.mode << "), время: " << elapsed << " с\n"
+             << "Ходов: " << stats.moves << " (" << stats.moves / elapsed << " в секунду), закончено партий: "
+             << stats.games << ", ошибок: " << stats.errors << "\n"
+             << "Задержка хода: медиана " << percentile(0.5) << " мкс, 99% " << percentile(0.99) << " мкс\n"
+             << "На ядро (" << cores << "): партий " << double(sessions) / cores << ", ходов в секунду "
+             << stats.moves / elapsed / cores << "\n";
+    }
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "-p") && hasValue) {
+            options.port = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-u") && hasValue) {
+            options.unixPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-c") && hasValue) {
+            options.connections = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-s") && hasValue) {
+            options.sessions = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-m") && hasValue) {
+            options.mode = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-T") && hasValue) {
+            options.seconds = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-l") && hasValue) {
+            options.maxPlies = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--seed") && hasValue) {
+            options.seed = uint32_t(strtoul(argv[++i], nullptr, 10));
+        }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (options.port < 1 || options.port > 65535 || options.connections < 1 || options.sessions < 1
+        || options.mode < 1 || options.mode > 3 || options.seconds <= 0 || options.maxPlies < 1) {
+        usage();
+        return 1;
+    }
+
+    initBitboards();
+    LoadGenerator generator(options);
+    return generator.run() ? 0 : 1;
+}
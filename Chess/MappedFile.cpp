@@ -0,0 +1,113 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::open(const std::string& path, Access access) {
+    close();
+
+    DWORD flags = (access == Access::SEQUENTIAL) ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, flags, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    length = size_t(fileSize.QuadPart);
+    opened = true;
+    if (length == 0) {
+        return true;
+    }
+
+    mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle) {
+        mapped = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (!mapped) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (mapped) {
+        UnmapViewOfFile(mapped);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle) {
+        CloseHandle(fileHandle);
+    }
+    mapped = nullptr;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+    length = 0;
+    opened = false;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path, Access access) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    length = size_t(st.st_size);
+    if (length > 0) {
+        void* memory = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (memory == MAP_FAILED) {
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        mapped = static_cast<const char*>(memory);
+        // Последовательное чтение (каждым потоком - своя часть) или выборочное
+        madvise(memory, length, access == Access::SEQUENTIAL ? MADV_SEQUENTIAL : MADV_RANDOM);
+    }
+
+    // Отображение остается действительным и после закрытия дескриптора
+    ::close(fd);
+    opened = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (mapped) {
+        munmap(const_cast<char*>(mapped), length);
+    }
+    mapped = nullptr;
+    length = 0;
+    opened = false;
+}
+
+#endif
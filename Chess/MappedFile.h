@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Файл, отображенный в память только для чтения. Содержимое читается прямо из
+// страниц файла без копирования; пустой файл открывается с нулевым размером
+class MappedFile {
+private:
+    const char* mapped = nullptr;
+    size_t length = 0;
+    bool opened = false;
+#if defined(_WIN32)
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Порядок чтения: подсказка системе, подгружать ли страницы с опережением
+    enum class Access { SEQUENTIAL, RANDOM };
+
+    // Открытие файла; false, если файл не удалось открыть или отобразить
+    bool open(const std::string& path, Access access = Access::SEQUENTIAL);
+    void close();
+
+    bool isOpen() const {
+        return opened;
+    }
+
+    const char* data() const {
+        return mapped;
+    }
+
+    size_t size() const {
+        return length;
+    }
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+// Ход, упакованный в 16 бит: биты 0-5 - клетка "откуда", 6-11 - клетка "куда",
+// 12-13 - фигура превращения (0 - конь, 1 - слон, 2 - ладья, 3 - ферзь),
+// 14-15 - вид хода. У обычного хода вид 0, поэтому особые ходы отделяются одной
+// редко срабатывающей проверкой moveType(m) != MOVE_NORMAL
+typedef uint16_t Move;
+
+const Move MOVE_NONE = 0; // a1-a1 никогда не бывает допустимым ходом
+
+// Виды ходов; рокировка записывается ходом короля (e1g1), взятие на проходе -
+// ходом пешки на поле, через которое прошла пешка соперника
+const int MOVE_NORMAL = 0;
+const int MOVE_PROMOTION = 1 << 14;
+const int MOVE_EN_PASSANT = 2 << 14;
+const int MOVE_CASTLING = 3 << 14;
+
+inline constexpr Move encodeMove(int from, int to, int type = MOVE_NORMAL, int promotion = 0) {
+    return Move(from | (to << 6) | (promotion << 12) | type);
+}
+inline constexpr int moveFrom(Move m) { return m & 0x3F; }
+inline constexpr int moveTo(Move m) { return (m >> 6) & 0x3F; }
+inline constexpr int moveType(Move m) { return m & (3 << 14); }
+inline constexpr int movePromotion(Move m) { return (m >> 12) & 3; }
+
+// Что генерировать: только взятия (вместе со всеми превращениями и взятием на
+// проходе), только тихие ходы (вместе с рокировкой) или все сразу
+enum class GenType { CAPTURES, QUIETS, ALL };
+
+// Список ходов фиксированной емкости, размещаемый на стеке (без выделения памяти).
+// В любой позиции не больше 218 допустимых ходов
+struct MoveList {
+    static const int CAPACITY = 256;
+
+    Move moves[CAPACITY];
+    int count = 0;
+
+    void add(Move m) { moves[count++] = m; }
+    void clear() { count = 0; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool contains(Move m) const {
+        for (int i = 0; i < count; ++i) {
+            if (moves[i] == m) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Move operator[](int i) const { return moves[i]; }
+    Move* begin() { return moves; }
+    Move* end() { return moves + count; }
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + count; }
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Bitboard.h"
+
+// Упакованная позиция, 32 байта: битборд занятости и по полубайту на каждую
+// фигуру в порядке возрастания номеров клеток (до 32 фигур - 16 байт).
+// Код фигуры: тип (PieceType, 0-5) для белых, тип + 8 для черных
+struct PackedPosition {
+    Bitboard occupied = 0;
+    uint8_t pieces[16] = {};
+    uint8_t flags = 0;        // Бит 0 - ходят черные, биты 1-4 - права на рокировку KQkq
+    int8_t epSquare = -1;     // Клетка взятия на проходе (-1, если нет)
+    uint16_t ply = 0;         // Номер полухода от начала партии
+    int16_t score = 0;        // Оценка позиции (для архивов самоигры), 0 - нет
+    uint8_t halfmove = 0;     // Полуходы без взятий и ходов пешек (до 255)
+    uint8_t reserved = 0;
+
+    static const int BLACK_FLAG = 1;
+    static const int CASTLING_SHIFT = 1;
+    static const int BLACK_PIECE = 8;
+    static const int MAX_PIECES = 32;
+
+    int pieceCode(int index) const {
+        return (pieces[index / 2] >> (4 * (index % 2))) & 0xF;
+    }
+
+    // false - номер за пределами 32 фигур, код не записан
+    bool setPieceCode(int index, int code) {
+        if (index < 0 || index >= MAX_PIECES) {
+            return false;
+        }
+        pieces[index / 2] = uint8_t(pieces[index / 2] | ((code & 0xF) << (4 * (index % 2))));
+        return true;
+    }
+};
+
+static_assert(sizeof(PackedPosition) == 32, "PackedPosition must stay 32 bytes");
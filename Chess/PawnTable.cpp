@@ -0,0 +1,19 @@
+#include "PawnTable.h"
+
+void PawnTable::resize(size_t count) {
+    size_t size = 0;
+    if (count > 0) {
+        size = 1;
+        while (size * 2 <= count) {
+            size *= 2;
+        }
+    }
+    entries.assign(size, Entry());
+    entries.shrink_to_fit();
+    resetStats();
+}
+
+void PawnTable::clear() {
+    entries.assign(entries.size(), Entry());
+    resetStats();
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Bitboard.h"
+#include "TranspositionTable.h"
+
+// Оценка пешечной структуры (перевес белых), проходные и кандидаты в проходные
+// пешки обоих цветов
+struct PawnEval {
+    int mg = 0;
+    int eg = 0;
+    Bitboard passed[2] = {};
+    Bitboard candidates[2] = {};
+};
+
+// Пешечный хеш: оценки пешечной структуры по ключу одних пешек. Структура
+// меняется редко (ходами пешек и их взятиями), поэтому почти каждая оценка
+// находит готовую запись. У каждого потока перебора своя таблица, поэтому
+// записи и счетчики не требуют синхронизации. Статистика - в формате TTStats
+// (probes, hits, stores; collisions - запись вытеснила другую структуру)
+class PawnTable {
+private:
+    struct Entry {
+        uint64_t key = 0;
+        PawnEval eval;
+    };
+
+    std::vector<Entry> entries;
+    TTStats stats;
+
+public:
+    // Число записей по умолчанию (около 768 КБ)
+    static const size_t DEFAULT_ENTRIES = 1 << 14;
+
+    explicit PawnTable(size_t count = DEFAULT_ENTRIES) {
+        resize(count);
+    }
+
+    // count округляется вниз до степени двойки; 0 - таблица отключена
+    void resize(size_t count);
+
+    // Очистка записей. Пустая запись с ключом 0 верна: это оценка доски без пешек
+    void clear();
+
+    bool enabled() const {
+        return !entries.empty();
+    }
+
+    // Запись для ключа или nullptr
+    const PawnEval* probe(uint64_t key) {
+        ++stats.probes;
+        const Entry& entry = entries[key & (entries.size() - 1)];
+        if (entry.key != key) {
+            return nullptr;
+        }
+        ++stats.hits;
+        return &entry.eval;
+    }
+
+    void store(uint64_t key, const PawnEval& eval) {
+        Entry& entry = entries[key & (entries.size() - 1)];
+        ++stats.stores;
+        if (entry.key != 0 && entry.key != key) {
+            ++stats.collisions;
+        }
+        entry.key = key;
+        entry.eval = eval;
+    }
+
+    const TTStats& statistics() const {
+        return stats;
+    }
+
+    void resetStats() {
+        stats = TTStats();
+    }
+};
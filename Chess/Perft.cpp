@@ -0,0 +1,223 @@
+// Перфт: подсчет листьев дерева ходов до заданной глубины.
+// Используется для проверки генератора ходов и замера его скорости.
+//
+//   perft [-d N] [-m 1|2|3 | -f "FEN"] [--divide]   - подсчет и скорость
+//   perft --check                                  - сверка с эталонными числами
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "ChessBoard.h"
+
+using namespace std;
+
+namespace {
+
+// Эталонные значения для стандартных позиций
+struct PerftCase {
+    const char* name;
+    const char* fen;
+    int depth;
+    uint64_t nodes;
+};
+
+const char* const START = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+const char* const KIWIPETE = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+const char* const POSITION3 = "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1";
+const char* const POSITION4 = "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1";
+const char* const POSITION5 = "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8";
+const char* const POSITION6 = "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10";
+const char* const PROMOTIONS = "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1";
+
+// Общепринятый набор: рокировки (kiwipete), взятие на проходе со вскрытым шахом
+// (position3), превращения со взятием и под шахом (position4, 5, promotions), а также
+// короткие позиции на отдельные правила
+const PerftCase KnownResults[] = {
+    { "start", START, 1, 20 },
+    { "start", START, 2, 400 },
+    { "start", START, 3, 8902 },
+    { "start", START, 4, 197281 },
+    { "start", START, 5, 4865609 },
+    { "kiwipete", KIWIPETE, 1, 48 },
+    { "kiwipete", KIWIPETE, 2, 2039 },
+    { "kiwipete", KIWIPETE, 3, 97862 },
+    { "kiwipete", KIWIPETE, 4, 4085603 },
+    { "position3", POSITION3, 1, 14 },
+    { "position3", POSITION3, 2, 191 },
+    { "position3", POSITION3, 3, 2812 },
+    { "position3", POSITION3, 4, 43238 },
+    { "position3", POSITION3, 5, 674624 },
+    { "position4", POSITION4, 1, 6 },
+    { "position4", POSITION4, 2, 264 },
+    { "position4", POSITION4, 3, 9467 },
+    { "position4", POSITION4, 4, 422333 },
+    { "position4-mirror", "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1", 4, 422333 },
+    { "position5", POSITION5, 1, 44 },
+    { "position5", POSITION5, 2, 1486 },
+    { "position5", POSITION5, 3, 62379 },
+    { "position5", POSITION5, 4, 2103487 },
+    { "position6", POSITION6, 1, 46 },
+    { "position6", POSITION6, 2, 2079 },
+    { "position6", POSITION6, 3, 89890 },
+    { "position6", POSITION6, 4, 3894594 },
+    { "promotions", PROMOTIONS, 1, 24 },
+    { "promotions", PROMOTIONS, 2, 496 },
+    { "promotions", PROMOTIONS, 3, 9483 },
+    { "promotions", PROMOTIONS, 4, 182838 },
+    { "promotions", PROMOTIONS, 5, 3605103 },
+    { "illegal-ep", "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1", 6, 1134888 },
+    { "ep-check", "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1", 6, 1015133 },
+    { "ep-pin", "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 6, 1440467 },
+    { "castle-check", "5k2/8/8/8/8/8/8/4K2R w K - 0 1", 6, 661072 },
+    { "long-castle-check", "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", 6, 803711 },
+    { "castle-rights", "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1", 4, 1274206 },
+    { "castle-prevented", "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 4, 1720476 },
+    { "promote-out-of-check", "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", 6, 3821001 },
+    { "discovered-check", "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1", 5, 1004658 },
+    { "promote-check", "4k3/1P6/8/8/8/8/K7/8 w - - 0 1", 6, 217342 },
+    { "underpromote-check", "8/P1k5/K7/8/8/8/8/8 w - - 0 1", 6, 92683 },
+    { "self-stalemate", "K1k5/8/P7/8/8/8/8/8 w - - 0 1", 6, 2217 },
+    { "stalemate-mate", "8/k1P5/8/1K6/8/8/8/8 w - - 0 1", 7, 567584 },
+    { "double-check", "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", 4, 23527 },
+};
+
+const char* ModeNames[] = { "", "кони и короли", "пешки и короли", "стандартные шахматы" };
+
+// Подсчет листьев; на последнем уровне достаточно размера списка ходов
+uint64_t perft(ChessBoard& board, int depth) {
+    MoveList list;
+    board.generateMoves(list);
+    if (depth <= 1) {
+        return depth == 1 ? list.size() : 1;
+    }
+
+    uint64_t nodes = 0;
+    for (Move move : list) {
+        board.makeMove(move);
+        nodes += perft(board, depth - 1);
+        board.unmakeMove();
+    }
+    return nodes;
+}
+
+// Подсчет с разбивкой по ходам корня (divide)
+uint64_t divide(ChessBoard& board, int depth) {
+    MoveList list;
+    board.generateMoves(list);
+
+    uint64_t total = 0;
+    for (Move move : list) {
+        board.makeMove(move);
+        uint64_t nodes = perft(board, depth - 1);
+        board.unmakeMove();
+        cout << "  " << moveToString(move) << ": " << nodes << "\n";
+        total += nodes;
+    }
+    return total;
+}
+
+// Подсчет с замером времени и выводом скорости
+void run(ChessBoard& board, const string& title, int depth, bool showDivide) {
+    auto start = chrono::steady_clock::now();
+    uint64_t nodes = showDivide ? divide(board, depth) : perft(board, depth);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << title << ", глубина " << depth << ": " << nodes << " узлов, "
+         << fixed << setprecision(3) << seconds << " с, "
+         << setprecision(2) << (seconds > 0 ? nodes / seconds / 1e6 : 0.0) << " млн узлов/с\n";
+}
+
+// Сверка со всеми эталонными значениями; возвращает число расхождений
+int check() {
+    int failures = 0;
+    for (const PerftCase& c : KnownResults) {
+        ChessBoard board;
+        if (!board.loadFen(c.fen)) {
+            cout << "ОШИБКА  " << c.name << ": не удалось разобрать FEN\n";
+            ++failures;
+            continue;
+        }
+        uint64_t nodes = perft(board, c.depth);
+        bool ok = nodes == c.nodes;
+        cout << (ok ? "OK      " : "ОШИБКА  ") << c.name << ", глубина " << c.depth
+             << ": " << nodes << " (ожидается " << c.nodes << ")\n";
+        if (!ok) {
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+void usage() {
+    cout << "Использование:\n"
+         << "  perft [-d N] [-m 1|2|3 | -f \"FEN\"] [--divide]\n"
+         << "  perft --check\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int depth = 5;
+    int mode = 0;
+    string fen;
+    bool showDivide = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--check")) {
+            int failures = check();
+            if (failures) {
+                cout << "Есть расхождения: " << failures << "\n";
+            }
+            else {
+                cout << "Все проверки пройдены\n";
+            }
+            return failures ? 1 : 0;
+        }
+        else if (!strcmp(argv[i], "--divide")) {
+            showDivide = true;
+        }
+        else if (!strcmp(argv[i], "-d") && i + 1 < argc) {
+            depth = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-m") && i + 1 < argc) {
+            mode = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-f") && i + 1 < argc) {
+            fen = argv[++i];
+        }
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    if (depth < 1 || mode < 0 || mode > 3) {
+        usage();
+        return 1;
+    }
+
+    if (!fen.empty()) {
+        ChessBoard board;
+        if (!board.loadFen(fen)) {
+            cout << "Некорректный FEN: " << fen << "\n";
+            return 1;
+        }
+        run(board, "FEN", depth, showDivide);
+        return 0;
+    }
+
+    // Без явной позиции считаем стартовые позиции всех трех режимов
+    for (int m = 1; m <= 3; ++m) {
+        if (mode && m != mode) {
+            continue;
+        }
+        ChessBoard board(m);
+        run(board, string("Режим ") + to_string(m) + " (" + ModeNames[m] + ")", depth, showDivide);
+    }
+    return 0;
+}
@@ -0,0 +1,182 @@
+#include "Profile.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+const char* PointNames[] = {
+    "isMoveValid", "isInCheck", "isCheckmate", "isStalemate", "hasLegalMoves",
+    "generateMoves", "makeMoveChecked", "makeMove", "unmakeMove"
+};
+static_assert(sizeof(PointNames) / sizeof(PointNames[0]) == size_t(ProfilePoint::COUNT),
+              "PointNames must list every ProfilePoint");
+
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+const char* TickUnit = "cycles";
+#else
+const char* TickUnit = "ns";
+#endif
+
+struct Totals {
+    uint64_t calls[int(ProfilePoint::COUNT)] = {};
+    uint64_t ticks[int(ProfilePoint::COUNT)] = {};
+};
+
+#if defined(CHESS_PROFILE)
+
+// Итоги завершенных потоков и счетчики работающих. Реестр не разрушается:
+// потоки могут завершаться и после деструкторов статических объектов
+struct Registry {
+    std::mutex mutex;
+    std::vector<ProfileCounters*> live;
+    Totals retired;
+};
+
+Registry& registry() {
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+void addCounters(Totals& totals, const ProfileCounters& counters) {
+    for (int i = 0; i < int(ProfilePoint::COUNT); ++i) {
+        totals.calls[i] += counters.calls[i].load(std::memory_order_relaxed);
+        totals.ticks[i] += counters.ticks[i].load(std::memory_order_relaxed);
+    }
+}
+
+// Счетчики потока: регистрируются при создании, при выходе из потока
+// переносятся в итоги завершенных
+struct ThreadCounters {
+    ProfileCounters counters;
+
+    ThreadCounters() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.live.push_back(&counters);
+    }
+
+    ~ThreadCounters() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        addCounters(r.retired, counters);
+        for (size_t i = 0; i < r.live.size(); ++i) {
+            if (r.live[i] == &counters) {
+                r.live[i] = r.live.back();
+                r.live.pop_back();
+                break;
+            }
+        }
+    }
+};
+
+Totals collect() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    Totals totals = r.retired;
+    for (const ProfileCounters* counters : r.live) {
+        addCounters(totals, *counters);
+    }
+    return totals;
+}
+
+// Итоги при завершении программы (к этому моменту счетчики главного потока
+// уже перенесены в итоги завершенных)
+struct ExitReport {
+    ~ExitReport() {
+        const char* path = std::getenv("CHESS_PROFILE_OUT");
+        if (path && *path) {
+            profileWriteFile(path);
+        }
+        else {
+            profileWrite(std::cerr, ProfileFormat::CSV);
+        }
+    }
+} exitReport;
+
+#else
+
+Totals collect() {
+    return Totals();
+}
+
+#endif
+
+} // namespace
+
+#if defined(CHESS_PROFILE)
+
+ProfileCounters& profileCounters() {
+    thread_local ThreadCounters local;
+    return local.counters;
+}
+
+bool profileEnabled() {
+    return true;
+}
+
+void profileReset() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.retired = Totals();
+    for (ProfileCounters* counters : r.live) {
+        for (int i = 0; i < int(ProfilePoint::COUNT); ++i) {
+            counters->calls[i].store(0, std::memory_order_relaxed);
+            counters->ticks[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+#else
+
+bool profileEnabled() {
+    return false;
+}
+
+void profileReset() {
+}
+
+#endif
+
+void profileWrite(std::ostream& out, ProfileFormat format) {
+    Totals totals = collect();
+    out << std::fixed << std::setprecision(1);
+    if (format == ProfileFormat::CSV) {
+        out << "function,calls," << TickUnit << "," << TickUnit << "_per_call\n";
+    }
+    else {
+        out << "{\n  \"enabled\": " << (profileEnabled() ? "true" : "false")
+            << ",\n  \"unit\": \"" << TickUnit << "\",\n  \"functions\": [";
+    }
+
+    for (int i = 0; i < int(ProfilePoint::COUNT); ++i) {
+        uint64_t calls = totals.calls[i];
+        uint64_t ticks = totals.ticks[i];
+        double perCall = calls ? double(ticks) / double(calls) : 0.0;
+        if (format == ProfileFormat::CSV) {
+            out << PointNames[i] << "," << calls << "," << ticks << "," << perCall << "\n";
+        }
+        else {
+            out << (i ? "," : "") << "\n    { \"name\": \"" << PointNames[i] << "\", \"calls\": " << calls
+                << ", \"ticks\": " << ticks << ", \"perCall\": " << perCall << " }";
+        }
+    }
+    if (format == ProfileFormat::JSON) {
+        out << "\n  ]\n}\n";
+    }
+    out.flush();
+}
+
+bool profileWriteFile(const std::string& path) {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+    profileWrite(file, csv ? ProfileFormat::CSV : ProfileFormat::JSON);
+    return bool(file);
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#if defined(CHESS_PROFILE)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+#endif
+
+// Счетчики горячих функций правил: число вызовов и время в них (такты rdtsc на
+// x86, иначе наносекунды steady_clock; время вложенных вызовов входит в время
+// вызывающей функции). Включаются при сборке с CHESS_PROFILE (опция CMake); без
+// него PROFILE_SCOPE разворачивается в пустое выражение и ничего не стоит.
+// Каждый поток пишет в свои счетчики без блокировок и атомарных операций
+// чтения-изменения; при выходе из потока они прибавляются к общим итогам.
+// Итоги выводятся при завершении программы (в файл из переменной окружения
+// CHESS_PROFILE_OUT или в stderr) или по запросу через profileWrite
+
+enum class ProfilePoint {
+    IS_MOVE_VALID,
+    IS_IN_CHECK,
+    IS_CHECKMATE,
+    IS_STALEMATE,
+    HAS_LEGAL_MOVES,
+    GENERATE_MOVES,
+    MAKE_MOVE_CHECKED,  // makeMove(from, to) с проверкой правил
+    MAKE_MOVE,          // makeMove(Move) перебора
+    UNMAKE_MOVE,
+    COUNT
+};
+
+// Вид вывода итогов: JSON или CSV (по строке на функцию)
+enum class ProfileFormat { JSON, CSV };
+
+// Собраны ли программа и библиотека с CHESS_PROFILE
+bool profileEnabled();
+
+// Итоги по всем потокам (завершенным и работающим) на момент вызова
+void profileWrite(std::ostream& out, ProfileFormat format);
+
+// Запись итогов в файл; формат по расширению (.csv - CSV, иначе JSON)
+bool profileWriteFile(const std::string& path);
+
+// Обнуление счетчиков всех потоков
+void profileReset();
+
+#if defined(CHESS_PROFILE)
+
+inline uint64_t profileTicks() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// Счетчики одного потока. Пишет только поток-владелец, поэтому приращение -
+// обычные загрузка и запись; atomic нужен только для чтения итогов из других потоков
+struct ProfileCounters {
+    std::atomic<uint64_t> calls[int(ProfilePoint::COUNT)] = {};
+    std::atomic<uint64_t> ticks[int(ProfilePoint::COUNT)] = {};
+
+    void add(ProfilePoint point, uint64_t elapsed) {
+        std::atomic<uint64_t>& c = calls[int(point)];
+        std::atomic<uint64_t>& t = ticks[int(point)];
+        c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        t.store(t.load(std::memory_order_relaxed) + elapsed, std::memory_order_relaxed);
+    }
+};
+
+// Счетчики текущего потока (регистрируются при первом обращении)
+ProfileCounters& profileCounters();
+
+// Замер области видимости: от создания до выхода из функции
+class ProfileScope {
+private:
+    ProfilePoint point;
+    uint64_t start;
+
+public:
+    explicit ProfileScope(ProfilePoint p) : point(p), start(profileTicks()) {
+    }
+
+    ~ProfileScope() {
+        profileCounters().add(point, profileTicks() - start);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define PROFILE_SCOPE(point) ProfileScope profileScope_(ProfilePoint::point)
+
+#else
+
+#define PROFILE_SCOPE(point) ((void)0)
+
+#endif
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+
+// Материал и таблицы "фигура-клетка" для миттельшпиля (mg) и эндшпиля (eg).
+// Таблицы ниже записаны с точки зрения белых, как на диаграмме: первая строка -
+// 8-я горизонталь. Порядок фигур: KING, QUEEN, ROOK, BISHOP, KNIGHT, PAWN
+
+inline constexpr int MaterialMg[6] = { 0, 1025, 477, 365, 337, 82 };
+inline constexpr int MaterialEg[6] = { 0, 936, 512, 297, 281, 94 };
+
+// Вес фигуры в стадии партии: 24 - полный набор, 0 - только короли и пешки
+inline constexpr int PhaseWeight[6] = { 0, 4, 2, 1, 1, 0 };
+const int PHASE_MAX = 24;
+
+namespace psqt_detail {
+
+inline constexpr int16_t KingMg[64] = {
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -20, -30, -30, -40, -40, -30, -30, -20,
+    -10, -20, -20, -20, -20, -20, -20, -10,
+     20,  20,   0,   0,   0,   0,  20,  20,
+     20,  30,  10,   0,   0,  10,  30,  20,
+};
+
+inline constexpr int16_t KingEg[64] = {
+    -50, -40, -30, -20, -20, -30, -40, -50,
+    -30, -20, -10,   0,   0, -10, -20, -30,
+    -30, -10,  20,  30,  30,  20, -10, -30,
+    -30, -10,  30,  40,  40,  30, -10, -30,
+    -30, -10,  30,  40,  40,  30, -10, -30,
+    -30, -10,  20,  30,  30,  20, -10, -30,
+    -30, -30,   0,   0,   0,   0, -30, -30,
+    -50, -30, -30, -30, -30, -30, -30, -50,
+};
+
+inline constexpr int16_t Queen[64] = {
+    -20, -10, -10,  -5,  -5, -10, -10, -20,
+    -10,   0,   0,   0,   0,   0,   0, -10,
+    -10,   0,   5,   5,   5,   5,   0, -10,
+     -5,   0,   5,   5,   5,   5,   0,  -5,
+      0,   0,   5,   5,   5,   5,   0,  -5,
+    -10,   5,   5,   5,   5,   5,   0, -10,
+    -10,   0,   5,   0,   0,   0,   0, -10,
+    -20, -10, -10,  -5,  -5, -10, -10, -20,
+};
+
+inline constexpr int16_t Rook[64] = {
+      0,   0,   0,   0,   0,   0,   0,   0,
+      5,  10,  10,  10,  10,  10,  10,   5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+      0,   0,   0,   5,   5,   0,   0,   0,
+};
+
+inline constexpr int16_t Bishop[64] = {
+    -20, -10, -10, -10, -10, -10, -10, -20,
+    -10,   0,   0,   0,   0,   0,   0, -10,
+    -10,   0,   5,  10,  10,   5,   0, -10,
+    -10,   5,   5,  10,  10,   5,   5, -10,
+    -10,   0,  10,  10,  10,  10,   0, -10,
+    -10,  10,  10,  10,  10,  10,  10, -10,
+    -10,   5,   0,   0,   0,   0,   5, -10,
+    -20, -10, -10, -10, -10, -10, -10, -20,
+};
+
+inline constexpr int16_t Knight[64] = {
+    -50, -40, -30, -30, -30, -30, -40, -50,
+    -40, -20,   0,   0,   0,   0, -20, -40,
+    -30,   0,  10,  15,  15,  10,   0, -30,
+    -30,   5,  15,  20,  20,  15,   5, -30,
+    -30,   0,  15,  20,  20,  15,   0, -30,
+    -30,   5,  10,  15,  15,  10,   5, -30,
+    -40, -20,   0,   5,   5,   0, -20, -40,
+    -50, -40, -30, -30, -30, -30, -40, -50,
+};
+
+inline constexpr int16_t PawnMg[64] = {
+      0,   0,   0,   0,   0,   0,   0,   0,
+     50,  50,  50,  50,  50,  50,  50,  50,
+     10,  10,  20,  30,  30,  20,  10,  10,
+      5,   5,  10,  25,  25,  10,   5,   5,
+      0,   0,   0,  20,  20,   0,   0,   0,
+      5,  -5, -10,   0,   0, -10,  -5,   5,
+      5,  10,  10, -20, -20,  10,  10,   5,
+      0,   0,   0,   0,   0,   0,   0,   0,
+};
+
+// В эндшпиле пешка ценна прежде всего продвижением
+inline constexpr int16_t PawnEg[64] = {
+      0,   0,   0,   0,   0,   0,   0,   0,
+     80,  80,  80,  80,  80,  80,  80,  80,
+     50,  50,  50,  50,  50,  50,  50,  50,
+     30,  30,  30,  30,  30,  30,  30,  30,
+     15,  15,  15,  15,  15,  15,  15,  15,
+      5,   5,   5,   5,   5,   5,   5,   5,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+};
+
+inline constexpr const int16_t* TablesMg[6] = { KingMg, Queen, Rook, Bishop, Knight, PawnMg };
+inline constexpr const int16_t* TablesEg[6] = { KingEg, Queen, Rook, Bishop, Knight, PawnEg };
+
+} // namespace psqt_detail
+
+// Итоговые таблицы с материалом: [цвет][тип фигуры][клетка], значения черных
+// со знаком минус, так что сумма по доске - перевес белых. Раскладка SoA:
+// миттельшпиль и эндшпиль - отдельные массивы, выровненные по линии кэша,
+// чтобы полный пересчет обрабатывал их векторными инструкциями
+struct PsqTables {
+    alignas(64) int16_t mg[2][6][64];
+    alignas(64) int16_t eg[2][6][64];
+};
+
+constexpr PsqTables makePsqTables() {
+    PsqTables t = {};
+    for (int c = 0; c < 2; ++c) {
+        for (int type = 0; type < 6; ++type) {
+            for (int sq = 0; sq < 64; ++sq) {
+                // Для белых клетка a1 (0) - левый нижний угол диаграммы (индекс 56)
+                int diagram = (c == 0) ? (sq ^ 56) : sq;
+                int sign = (c == 0) ? 1 : -1;
+                t.mg[c][type][sq] = int16_t(sign * (MaterialMg[type] + psqt_detail::TablesMg[type][diagram]));
+                t.eg[c][type][sq] = int16_t(sign * (MaterialEg[type] + psqt_detail::TablesEg[type][diagram]));
+            }
+        }
+    }
+    return t;
+}
+
+inline constexpr PsqTables Psqt = makePsqTables();
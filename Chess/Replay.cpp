@@ -0,0 +1,117 @@
+// Проигрывание двоичного архива партий (см. GameArchive.h).
+//
+//   replay [--fen] [--verify] <архив>
+//
+// Архив отображается в память; каждая партия восстанавливается из упакованной
+// начальной позиции и ходов. --fen выводит FEN каждой позиции, --verify сверяет
+// каждый ход со списком допустимых (без него ход только не должен противоречить
+// доске). В конце - число позиций и скорость
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "ChessBoard.h"
+#include "GameArchive.h"
+
+using namespace std;
+
+namespace {
+
+void usage() {
+    cout << "Использование:\n"
+         << "  replay [--fen] [--verify] <архив>\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool printFen = false;
+    bool verify = false;
+    string path;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--fen")) {
+            printFen = true;
+        }
+        else if (!strcmp(argv[i], "--verify")) {
+            verify = true;
+        }
+        else if (argv[i][0] != '-' && path.empty()) {
+            path = argv[i];
+        }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (path.empty()) {
+        usage();
+        return 1;
+    }
+
+    ArchiveReader archive;
+    if (!archive.open(path)) {
+        cerr << "Не удалось открыть архив: " << path << "\n";
+        return 1;
+    }
+
+    initBitboards();
+    ChessBoard board;
+    uint64_t positions = 0;
+    uint64_t errors = 0;
+    auto start = chrono::steady_clock::now();
+
+    for (uint64_t g = 0; g < archive.gameCount(); ++g) {
+        ArchiveGame game;
+        if (!archive.game(g, game)) {
+            cerr << "Партия " << g << ": запись за пределами архива\n";
+            ++errors;
+            continue;
+        }
+        if (!board.unpack(game.start())) {
+            cerr << "Партия " << g << ": некорректная начальная позиция\n";
+            ++errors;
+            continue;
+        }
+        ++positions;
+        if (printFen) {
+            cout << board.toFen() << "\n";
+        }
+
+        int count = game.moveCount();
+        for (int i = 0; i < count; ++i) {
+            // Без --verify ход проверяется только на согласие с доской (этого
+            // достаточно для makeMove), с --verify - по списку допустимых
+            Move move = game.move(i);
+            bool legal = board.isMoveWellFormed(move);
+            if (legal && verify) {
+                MoveList list;
+                board.generateMoves(list);
+                legal = list.contains(move);
+            }
+            if (!legal) {
+                cerr << "Партия " << g << ", полуход " << i + 1 << ": недопустимый ход "
+                     << moveToString(move) << "\n";
+                ++errors;
+                break;
+            }
+            board.makeMove(move);
+            ++positions;
+            if (printFen) {
+                cout << board.toFen() << "\n";
+            }
+        }
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout.flush();
+    cerr << "Партий: " << archive.gameCount() << ", позиций: " << positions << ", ошибок: " << errors
+         << ", размер " << archive.sizeBytes() << " байт\n"
+         << fixed << setprecision(3) << seconds << " с, "
+         << setprecision(1) << (seconds > 0 ? positions / seconds / 1e6 : 0.0) << " млн позиций/с\n";
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,388 @@
+#include "Search.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Стоимость фигур: KING, QUEEN, ROOK, BISHOP, KNIGHT, PAWN, NONE
+const int PieceValues[7] = { 0, 900, 500, 330, 320, 100, 0 };
+
+// Порядок "наименее ценного нападающего" для MVV-LVA
+const int AttackerRank[7] = { 6, 5, 4, 3, 2, 1, 0 };
+
+const int MAX_DEPTH = 64;
+const uint64_t CHECK_INTERVAL = 2048;   // Как часто (в узлах) проверять время
+
+// Веса упорядочивания: лучший ход прошлой итерации, взятия, убийцы, история
+const int ROOT_BEST_ORDER = 1 << 30;
+const int CAPTURE_ORDER = 1 << 28;
+const int KILLER_ORDER = 1 << 27;
+const int HISTORY_MAX = 1 << 20;
+const int TT_MOVE_ORDER = ROOT_BEST_ORDER;
+
+// Пропуск глубин вспомогательными потоками Lazy SMP: поток с номером i
+// перебирает глубину d, только если ((d + SkipPhase) / SkipSize) четно
+const int SKIP_TABLE_SIZE = 20;
+const int SkipSize[SKIP_TABLE_SIZE] = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+const int SkipPhase[SKIP_TABLE_SIZE] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+// Оценка мата в таблице хранится относительно текущего узла, а не корня
+int scoreToTable(int score, int ply) {
+    if (score > MATE_SCORE - MAX_PLY) {
+        return score + ply;
+    }
+    if (score < -MATE_SCORE + MAX_PLY) {
+        return score - ply;
+    }
+    return score;
+}
+
+int scoreFromTable(int score, int ply) {
+    if (score > MATE_SCORE - MAX_PLY) {
+        return score - ply;
+    }
+    if (score < -MATE_SCORE + MAX_PLY) {
+        return score + ply;
+    }
+    return score;
+}
+
+} // namespace
+
+int64_t Search::elapsedMs() const {
+    return (SearchSignals::now() - signals->startNs.load(std::memory_order_relaxed)) / 1000000;
+}
+
+void Search::checkLimits() {
+    if (signals->stop.load(std::memory_order_relaxed)) {
+        aborted = true;
+    }
+    else if (!signals->ponder.load(std::memory_order_relaxed)
+             && ((limits.moveTimeMs > 0 && elapsedMs() >= limits.moveTimeMs)
+                 || (limits.nodes > 0 && nodeCount() >= limits.nodes))) {
+        aborted = true;
+    }
+}
+
+void Search::clear() {
+    memset(killers, 0, sizeof(killers));
+    memset(history, 0, sizeof(history));
+    pawnTable.clear();
+}
+
+void Search::scoreMoves(const ChessBoard& board, const MoveList& list, Move ttMove, int ply, int* scores) const {
+    int us = board.sideToMove() == Color::WHITE ? 0 : 1;
+    for (int i = 0; i < list.size(); ++i) {
+        Move move = list[i];
+        int from = moveFrom(move);
+        int to = moveTo(move);
+        PieceType victim = moveType(move) == MOVE_EN_PASSANT ? PieceType::PAWN : board.typeAt(to);
+
+        if (ply == 0 && move == rootBest) {
+            scores[i] = ROOT_BEST_ORDER;
+        }
+        else if (move == ttMove) {
+            scores[i] = TT_MOVE_ORDER - 1;
+        }
+        else if (victim != PieceType::NONE) {
+            // MVV-LVA: самая ценная жертва, самый дешевый нападающий
+            scores[i] = CAPTURE_ORDER + PieceValues[int(victim)] * 8 + AttackerRank[int(board.typeAt(from))];
+        }
+        else if (moveType(move) == MOVE_PROMOTION) {
+            // Превращение - как взятие новой фигуры; ферзь раньше слабых фигур
+            scores[i] = CAPTURE_ORDER + PieceValues[int(promotionType(move))] * 8;
+        }
+        else if (move == killers[ply][0]) {
+            scores[i] = KILLER_ORDER + 1;
+        }
+        else if (move == killers[ply][1]) {
+            scores[i] = KILLER_ORDER;
+        }
+        else {
+            scores[i] = history[us][from][to];
+        }
+    }
+}
+
+Move Search::pickMove(MoveList& list, int* scores, int index) {
+    // Частичная сортировка выбором: после отсечения остальные ходы сортировать не нужно
+    int best = index;
+    for (int i = index + 1; i < list.size(); ++i) {
+        if (scores[i] > scores[best]) {
+            best = i;
+        }
+    }
+    std::swap(list.moves[index], list.moves[best]);
+    std::swap(scores[index], scores[best]);
+    return list.moves[index];
+}
+
+void Search::updateQuietStats(const ChessBoard& board, Move move, int ply, int depth) {
+    if (killers[ply][0] != move) {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = move;
+    }
+
+    int us = board.sideToMove() == Color::WHITE ? 0 : 1;
+    int& h = history[us][moveFrom(move)][moveTo(move)];
+    h += depth * depth;
+    if (h > HISTORY_MAX) {
+        // Старение: уменьшаем всю таблицу, сохраняя относительный порядок
+        for (int c = 0; c < 2; ++c) {
+            for (int f = 0; f < 64; ++f) {
+                for (int t = 0; t < 64; ++t) {
+                    history[c][f][t] /= 2;
+                }
+            }
+        }
+    }
+}
+
+bool Search::probeTablebases(const ChessBoard& board, int ply, int& score) {
+    TbResult result;
+    if (!tablebases || popCount(board.occupied()) > tablebases->maxPieces()
+        || !tablebases->probe(board, result)) {
+        return false;
+    }
+    tbHits.store(tbHits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    score = (result.wdl > 0) ? MATE_SCORE - (ply + result.plies)
+          : (result.wdl < 0) ? -MATE_SCORE + ply + result.plies
+          : 0;
+    return true;
+}
+
+int Search::negamax(ChessBoard& board, int depth, int ply, int alpha, int beta) {
+    if (depth <= 0) {
+        return quiescence(board, ply, alpha, beta);
+    }
+
+    if ((countNode() & (CHECK_INTERVAL - 1)) == 0) {
+        checkLimits();
+    }
+    if (aborted) {
+        return 0;
+    }
+    if (ply >= MAX_PLY - 1) {
+        return evaluate(board, &pawnTable);
+    }
+
+    // Ничья по правилу 50 ходов или повторению; в переборе достаточно одного
+    // повтора: если повторение выгодно, его можно довести до троекратного
+    if (ply > 0 && (board.halfmoveClock() >= 100 || board.repetitionCount() > 0)) {
+        return 0;
+    }
+
+    // Позиция из таблиц эндшпиля: точный результат без перебора
+    int tbScore;
+    if (ply > 0 && probeTablebases(board, ply, tbScore)) {
+        return tbScore;
+    }
+
+    // Результат из хеш-таблицы: отсечение, если он получен на достаточной глубине
+    TTEntryData tt;
+    Move ttMove = MOVE_NONE;
+    uint64_t key = board.hashKey();
+    if (table && table->probe(key, tt, ttStats)) {
+        ttMove = tt.move;
+        int ttScore = scoreFromTable(tt.score, ply);
+        if (ply > 0 && tt.depth >= depth
+            && (tt.bound == Bound::EXACT
+                || (tt.bound == Bound::LOWER && ttScore >= beta)
+                || (tt.bound == Bound::UPPER && ttScore <= alpha))) {
+            return ttScore;
+        }
+    }
+
+    MoveList list;
+    board.generateMoves(list);
+    bool inCheck = board.isInCheck(board.sideToMove());
+    if (list.empty()) {
+        // Мат (чем ближе, тем хуже) или пат
+        return inCheck ? -MATE_SCORE + ply : 0;
+    }
+
+    // Продление при шахе
+    if (inCheck) {
+        ++depth;
+    }
+
+    int scores[MoveList::CAPACITY];
+    scoreMoves(board, list, ttMove, ply, scores);
+
+    int originalAlpha = alpha;
+    int bestScore = -INFINITE_SCORE;
+    Move bestMove = MOVE_NONE;
+    for (int i = 0; i < list.size(); ++i) {
+        Move move = pickMove(list, scores, i);
+        bool quiet = !board.isCapture(move) && moveType(move) != MOVE_PROMOTION;
+
+        board.makeMove(move);
+        int score = -negamax(board, depth - 1, ply + 1, -beta, -alpha);
+        board.unmakeMove();
+
+        // Результат прерванного поддерева недостоверен
+        if (aborted) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+            if (score > alpha) {
+                alpha = score;
+                if (ply == 0) {
+                    rootBest = move;
+                }
+                if (alpha >= beta) {
+                    if (quiet) {
+                        updateQuietStats(board, move, ply, depth);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    if (table) {
+        Bound bound = bestScore >= beta ? Bound::LOWER
+                    : bestScore > originalAlpha ? Bound::EXACT
+                    : Bound::UPPER;
+        table->store(key, bestMove, scoreToTable(bestScore, ply), depth, bound, ttStats);
+    }
+
+    return bestScore;
+}
+
+int Search::quiescence(ChessBoard& board, int ply, int alpha, int beta) {
+    if ((countNode() & (CHECK_INTERVAL - 1)) == 0) {
+        checkLimits();
+    }
+    if (aborted) {
+        return 0;
+    }
+
+    bool inCheck = board.isInCheck(board.sideToMove());
+    if (ply >= MAX_PLY - 1) {
+        return evaluate(board, &pawnTable);
+    }
+
+    int tbScore;
+    if (probeTablebases(board, ply, tbScore)) {
+        return tbScore;
+    }
+
+    MoveList list;
+    int bestScore = -INFINITE_SCORE;
+    if (inCheck) {
+        // Под шахом рассматриваем все ответы, оценка "стоя на месте" не допускается
+        board.generateMoves(list);
+        if (list.empty()) {
+            return -MATE_SCORE + ply;
+        }
+    }
+    else {
+        bestScore = evaluate(board, &pawnTable);
+        if (bestScore >= beta) {
+            return bestScore;
+        }
+        alpha = std::max(alpha, bestScore);
+        board.generateMoves(list, GenType::CAPTURES);
+    }
+
+    int scores[MoveList::CAPACITY];
+    scoreMoves(board, list, MOVE_NONE, ply, scores);
+
+    for (int i = 0; i < list.size(); ++i) {
+        Move move = pickMove(list, scores, i);
+
+        board.makeMove(move);
+        int score = -quiescence(board, ply + 1, -beta, -alpha);
+        board.unmakeMove();
+
+        if (aborted) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) {
+                    break;
+                }
+            }
+        }
+    }
+
+    return bestScore;
+}
+
+SearchResult Search::run(ChessBoard& board, const SearchLimits& searchLimits) {
+    limits = searchLimits;
+    resetNodes();
+    aborted = false;
+    memset(killers, 0, sizeof(killers));
+    ttStats = TTStats();
+    pawnTable.resetStats();
+    if (signals == &ownSignals) {
+        ownSignals.reset(false);
+        if (table) {
+            table->newSearch();
+        }
+    }
+
+    SearchResult result;
+    MoveList rootMoves;
+    board.generateMoves(rootMoves);
+    if (rootMoves.empty()) {
+        result.score = board.isInCheck(board.sideToMove()) ? -MATE_SCORE : 0;
+        return result;
+    }
+
+    result.bestMove = rootMoves[0];
+    rootBest = MOVE_NONE;
+
+    int maxDepth = limits.depth > 0 ? std::min(limits.depth, MAX_DEPTH) : MAX_DEPTH;
+    for (int depth = 1; depth <= maxDepth; ++depth) {
+        if (threadId > 0 && depth > 1) {
+            int i = (threadId - 1) % SKIP_TABLE_SIZE;
+            if (((depth + SkipPhase[i]) / SkipSize[i]) % 2) {
+                continue;
+            }
+        }
+
+        int score = negamax(board, depth, 0, -INFINITE_SCORE, INFINITE_SCORE);
+
+        if (aborted) {
+            // Из прерванной итерации берем только ход, который уже успел улучшить прежний
+            if (rootBest != MOVE_NONE) {
+                result.bestMove = rootBest;
+            }
+            break;
+        }
+
+        result.bestMove = rootBest;
+        result.score = score;
+        result.depth = depth;
+        result.nodes = nodeCount();
+        result.timeMs = elapsedMs();
+        if (onIteration) {
+            onIteration(result);
+        }
+
+        // Найден кратчайший мат или следующая итерация заведомо не уложится во время
+        if (isMateScore(score) && MATE_SCORE - std::abs(score) <= depth) {
+            break;
+        }
+        if (limits.moveTimeMs > 0 && result.timeMs * 2 > limits.moveTimeMs
+            && !signals->ponder.load(std::memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    result.nodes = nodeCount();
+    result.timeMs = elapsedMs();
+    return result;
+}
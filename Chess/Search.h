@@ -0,0 +1,175 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+#include "ChessBoard.h"
+#include "Evaluate.h"
+#include "Tablebase.h"
+#include "TranspositionTable.h"
+
+// Оценки в сантипешках; мат в n полуходов оценивается как MATE_SCORE - n
+const int MATE_SCORE = 32000;
+const int INFINITE_SCORE = 32001;
+const int MAX_PLY = 128;
+
+// Мат, найденный в пределах дерева перебора
+inline bool isMateScore(int score) {
+    return score > MATE_SCORE - MAX_PLY || score < -MATE_SCORE + MAX_PLY;
+}
+
+// Ограничения на перебор (0 - без ограничения)
+struct SearchLimits {
+    int depth = 0;           // Максимальная глубина итеративного углубления
+    int64_t moveTimeMs = 0;  // Бюджет времени на ход
+    uint64_t nodes = 0;      // Лимит узлов
+};
+
+// Сигналы управления перебором. В пуле потоков один экземпляр общий для всех
+// потоков; отдельно работающий Search пользуется собственным
+struct SearchSignals {
+    std::atomic<bool> stop{ false };      // Немедленно прекратить перебор
+    std::atomic<bool> ponder{ false };    // Думаем на время соперника: лимиты времени не действуют
+    std::atomic<int64_t> startNs{ 0 };    // Начало отсчета времени (steady_clock, нс)
+
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Сброс сигналов перед новым перебором
+    void reset(bool pondering) {
+        stop.store(false, std::memory_order_relaxed);
+        ponder.store(pondering, std::memory_order_relaxed);
+        startNs.store(now(), std::memory_order_relaxed);
+    }
+};
+
+// Итог перебора (или очередной итерации углубления)
+struct SearchResult {
+    Move bestMove = MOVE_NONE;
+    int score = 0;           // С точки зрения стороны, которой ходить
+    int depth = 0;           // Последняя полностью завершенная глубина
+    uint64_t nodes = 0;
+    int64_t timeMs = 0;
+
+    // Скорость перебора в узлах в секунду
+    uint64_t nps() const {
+        return timeMs > 0 ? nodes * 1000 / uint64_t(timeMs) : nodes * 1000;
+    }
+};
+
+// Перебор негамакс с альфа-бета отсечениями, итеративным углублением и
+// упорядочиванием ходов (MVV-LVA, ходы-убийцы, эвристика истории)
+class Search {
+private:
+    TranspositionTable* table = nullptr;   // Общая хеш-таблица (может отсутствовать)
+    TTStats ttStats;                       // Статистика обращений этого потока к таблице
+    PawnTable pawnTable;                   // Пешечный хеш этого потока
+    const Tablebases* tablebases = nullptr; // Таблицы эндшпиля (могут отсутствовать)
+    SearchSignals ownSignals;              // Сигналы для автономной работы
+    SearchSignals* signals = &ownSignals;  // Действующие сигналы (свои или общие для пула)
+    int threadId = 0;                      // Номер потока в пуле (0 - главный)
+    bool aborted = false;                  // Перебор прерван по времени, узлам или команде
+    SearchLimits limits;
+    std::atomic<uint64_t> nodes{ 0 };      // Читается другими потоками для статистики
+    std::atomic<uint64_t> tbHits{ 0 };     // Позиции, взятые из таблиц эндшпиля
+
+    Move rootBest = MOVE_NONE;             // Лучший ход предыдущей итерации
+    Move killers[MAX_PLY][2] = {};         // Тихие ходы, вызвавшие отсечение на этом уровне
+    int history[2][64][64] = {};           // Эвристика истории: [цвет][откуда][куда]
+
+    int64_t elapsedMs() const;
+
+    // Счетчик узлов: пишет только свой поток, поэтому атомарное сложение не нужно
+    uint64_t countNode() {
+        uint64_t n = nodes.load(std::memory_order_relaxed) + 1;
+        nodes.store(n, std::memory_order_relaxed);
+        return n;
+    }
+
+    // Проверка лимитов; вызывается раз в несколько тысяч узлов
+    void checkLimits();
+
+    // Точная оценка позиции из таблиц эндшпиля; false - позиции в таблицах нет
+    bool probeTablebases(const ChessBoard& board, int ply, int& score);
+
+    // Оценки ходов для упорядочивания и выбор лучшего из оставшихся
+    void scoreMoves(const ChessBoard& board, const MoveList& list, Move ttMove, int ply, int* scores) const;
+    static Move pickMove(MoveList& list, int* scores, int index);
+
+    // Запоминание тихого хода, вызвавшего отсечение
+    void updateQuietStats(const ChessBoard& board, Move move, int ply, int depth);
+
+    int negamax(ChessBoard& board, int depth, int ply, int alpha, int beta);
+    int quiescence(ChessBoard& board, int ply, int alpha, int beta);
+
+public:
+    explicit Search(TranspositionTable* tt = nullptr) : table(tt) {
+    }
+
+    // Подключение общей хеш-таблицы
+    void setTable(TranspositionTable* tt) {
+        table = tt;
+    }
+
+    // Подключение таблиц эндшпиля (nullptr - не использовать)
+    void setTablebases(const Tablebases* tb) {
+        tablebases = tb;
+    }
+
+    // Работа в составе пула: общие сигналы и номер потока. Вспомогательные
+    // потоки (id > 0) пропускают часть глубин, чтобы перебирать разные деревья
+    void joinPool(SearchSignals* shared, int id) {
+        signals = shared;
+        threadId = id;
+    }
+
+    uint64_t nodeCount() const {
+        return nodes.load(std::memory_order_relaxed);
+    }
+
+    // Обращения к таблицам эндшпиля с результатом в текущем переборе
+    uint64_t tablebaseHits() const {
+        return tbHits.load(std::memory_order_relaxed);
+    }
+
+    // Пул обнуляет счетчики всех потоков до запуска, чтобы сумма узлов
+    // не включала прошлый перебор еще не стартовавших потоков
+    void resetNodes() {
+        nodes.store(0, std::memory_order_relaxed);
+        tbHits.store(0, std::memory_order_relaxed);
+    }
+
+    // Статистика хеш-таблицы за последний перебор
+    const TTStats& tableStats() const {
+        return ttStats;
+    }
+
+    // Статистика пешечного хеша за последний перебор
+    const TTStats& pawnStats() const {
+        return pawnTable.statistics();
+    }
+
+    // Размер пешечного хеша в записях (0 - отключить)
+    void resizePawnTable(size_t entries) {
+        pawnTable.resize(entries);
+    }
+
+    // Вызывается после каждой завершенной итерации углубления
+    std::function<void(const SearchResult&)> onIteration;
+
+    // Поиск лучшего хода; доска возвращается в исходное состояние.
+    // Автономный Search сам сбрасывает сигналы; в пуле это делает пул до запуска
+    SearchResult run(ChessBoard& board, const SearchLimits& searchLimits);
+
+    // Досрочная остановка (можно вызывать из другого потока)
+    void stop() {
+        signals->stop.store(true, std::memory_order_relaxed);
+    }
+
+    // Очистка эвристик между партиями
+    void clear();
+};
@@ -0,0 +1,213 @@
+#include "SearchPool.h"
+
+#include <algorithm>
+
+SearchPool::SearchPool(TranspositionTable* tt, int threads) : table(tt) {
+    startThreads(threads);
+}
+
+SearchPool::~SearchPool() {
+    stopThreads();
+}
+
+void SearchPool::startThreads(int count) {
+    if (count < 1) {
+        count = std::max(1, int(std::thread::hardware_concurrency()));
+    }
+
+    // Сначала все потоки получают свои структуры, затем запускаются:
+    // вектор не меняется, пока потоки работают
+    for (int i = 0; i < count; ++i) {
+        workers.push_back(std::unique_ptr<Worker>(new Worker(table)));
+        workers.back()->search.joinPool(&signals, i);
+        workers.back()->search.setTablebases(tablebases);
+    }
+    workers[0]->search.onIteration = [this](const SearchResult& result) {
+        if (onIteration) {
+            onIteration(result);
+        }
+    };
+
+    quit = false;
+    for (int i = 0; i < count; ++i) {
+        workers[i]->thread = std::thread(&SearchPool::idleLoop, this, i);
+    }
+}
+
+void SearchPool::stopThreads() {
+    stop();
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    cv.notify_all();
+    for (auto& worker : workers) {
+        worker->thread.join();
+    }
+    workers.clear();
+}
+
+void SearchPool::setThreads(int threads) {
+    stopThreads();
+    startThreads(threads);
+}
+
+void SearchPool::idleLoop(int id) {
+    Worker& worker = *workers[id];
+    uint64_t done = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&] { return quit || job != done; });
+            if (quit) {
+                return;
+            }
+            done = job;
+        }
+
+        worker.result = worker.search.run(worker.board, limits);
+
+        if (id == 0) {
+            finishSearch();
+        }
+        else {
+            std::lock_guard<std::mutex> lock(mutex);
+            --running;
+            cv.notify_all();
+        }
+    }
+}
+
+void SearchPool::finishSearch() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // При обдумывании на время соперника ход выдается только по его команде
+    cv.wait(lock, [&] {
+        return !signals.ponder.load(std::memory_order_relaxed) || signals.stop.load(std::memory_order_relaxed);
+    });
+    signals.stop.store(true, std::memory_order_relaxed);
+    --running;
+    cv.wait(lock, [&] { return running == 0; });
+
+    // Побеждает наибольшая завершенная глубина; при равенстве - главный поток
+    SearchResult best = workers[0]->result;
+    uint64_t nodes = 0;
+    for (const auto& worker : workers) {
+        nodes += worker->result.nodes;
+        if (worker->result.bestMove != MOVE_NONE && worker->result.depth > best.depth) {
+            best = worker->result;
+        }
+    }
+    best.nodes = nodes;
+    best.timeMs = workers[0]->result.timeMs;
+    lastResult = best;
+
+    lock.unlock();
+    if (onFinish) {
+        onFinish(best);
+    }
+    lock.lock();
+
+    searching = false;
+    cv.notify_all();
+}
+
+void SearchPool::start(const ChessBoard& board, const SearchLimits& searchLimits, bool ponder) {
+    stop();
+    wait();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& worker : workers) {
+        worker->board = board;
+        worker->result = SearchResult();
+        worker->search.resetNodes();
+    }
+    limits = searchLimits;
+    signals.reset(ponder);
+    if (table) {
+        table->newSearch();
+    }
+    running = int(workers.size());
+    searching = true;
+    ++job;
+    cv.notify_all();
+}
+
+void SearchPool::ponderhit() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        signals.startNs.store(SearchSignals::now(), std::memory_order_relaxed);
+        signals.ponder.store(false, std::memory_order_relaxed);
+    }
+    cv.notify_all();
+}
+
+void SearchPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        signals.stop.store(true, std::memory_order_relaxed);
+    }
+    cv.notify_all();
+}
+
+SearchResult SearchPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return !searching; });
+    return lastResult;
+}
+
+bool SearchPool::isSearching() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return searching;
+}
+
+uint64_t SearchPool::nodesSearched() const {
+    uint64_t nodes = 0;
+    for (const auto& worker : workers) {
+        nodes += worker->search.nodeCount();
+    }
+    return nodes;
+}
+
+uint64_t SearchPool::tablebaseHits() const {
+    uint64_t hits = 0;
+    for (const auto& worker : workers) {
+        hits += worker->search.tablebaseHits();
+    }
+    return hits;
+}
+
+void SearchPool::setTablebases(const Tablebases* tb) {
+    wait();
+    tablebases = tb;
+    for (auto& worker : workers) {
+        worker->search.setTablebases(tb);
+    }
+}
+
+TTStats SearchPool::tableStats() const {
+    TTStats stats;
+    for (const auto& worker : workers) {
+        stats.merge(worker->search.tableStats());
+    }
+    return stats;
+}
+
+TTStats SearchPool::pawnStats() const {
+    TTStats stats;
+    for (const auto& worker : workers) {
+        stats.merge(worker->search.pawnStats());
+    }
+    return stats;
+}
+
+void SearchPool::clear() {
+    wait();
+    for (auto& worker : workers) {
+        worker->search.clear();
+    }
+    if (table) {
+        table->clear();
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ChessBoard.h"
+#include "Search.h"
+#include "TranspositionTable.h"
+
+// Параллельный перебор Lazy SMP. Каждый поток владеет своей копией доски и
+// своим Search (стеки ходов, ходы-убийцы, история); общие у потоков только
+// хеш-таблица и сигналы управления. Потоки создаются один раз и ждут задания.
+// Результат берется у главного потока (0), если вспомогательный не дошел глубже
+class SearchPool {
+private:
+    struct Worker {
+        ChessBoard board;
+        Search search;
+        SearchResult result;
+        std::thread thread;
+
+        explicit Worker(TranspositionTable* tt) : search(tt) {
+        }
+    };
+
+    TranspositionTable* table;
+    const Tablebases* tablebases = nullptr;
+    SearchSignals signals;                          // Общие для всех потоков
+    std::vector<std::unique_ptr<Worker>> workers;
+    SearchLimits limits;                            // Лимиты текущего перебора
+    SearchResult lastResult;
+
+    std::mutex mutex;
+    std::condition_variable cv;    // Одна переменная для всех событий пула
+    uint64_t job = 0;              // Номер задания: потоки ждут его изменения
+    int running = 0;               // Потоки, еще не закончившие текущее задание
+    bool searching = false;
+    bool quit = false;
+
+    void idleLoop(int id);
+
+    // Завершение перебора главным потоком: дождаться конца обдумывания на
+    // время соперника, остановить помощников и выбрать итоговый ход
+    void finishSearch();
+
+    void startThreads(int count);
+    void stopThreads();
+
+public:
+    // threads < 1 - по числу ядер
+    explicit SearchPool(TranspositionTable* tt, int threads = 1);
+    ~SearchPool();
+
+    SearchPool(const SearchPool&) = delete;
+    SearchPool& operator=(const SearchPool&) = delete;
+
+    // Изменение числа потоков; текущий перебор при этом останавливается
+    void setThreads(int threads);
+
+    // Подключение таблиц эндшпиля ко всем потокам (когда пул свободен)
+    void setTablebases(const Tablebases* tb);
+
+    int threadCount() const {
+        return int(workers.size());
+    }
+
+    // Итерации главного потока; вызывается из него же
+    std::function<void(const SearchResult&)> onIteration;
+
+    // Итог перебора; вызывается из главного потока перебора до того, как пул
+    // станет свободным
+    std::function<void(const SearchResult&)> onFinish;
+
+    // Запуск перебора без ожидания. ponder - думать на время соперника:
+    // лимиты времени не действуют до ponderhit(), результат не выдается до
+    // ponderhit() или stop()
+    void start(const ChessBoard& board, const SearchLimits& searchLimits, bool ponder = false);
+
+    // Соперник сделал ожидаемый ход: время отсчитывается с этого момента
+    void ponderhit();
+
+    // Досрочная остановка всех потоков (результат остается доступен)
+    void stop();
+
+    // Ожидание окончания перебора и его результат
+    SearchResult wait();
+
+    // Перебор с ожиданием результата
+    SearchResult run(const ChessBoard& board, const SearchLimits& searchLimits) {
+        start(board, searchLimits);
+        return wait();
+    }
+
+    bool isSearching();
+
+    // Узлы всех потоков в текущем (или последнем) переборе
+    uint64_t nodesSearched() const;
+
+    // Позиции, взятые из таблиц эндшпиля всеми потоками
+    uint64_t tablebaseHits() const;
+
+    // Сводная статистика хеш-таблицы по всем потокам (когда пул свободен)
+    TTStats tableStats() const;
+
+    // Сводная статистика пешечных хешей потоков (когда пул свободен)
+    TTStats pawnStats() const;
+
+    // Очистка хеш-таблицы и эвристик между партиями (когда пул свободен)
+    void clear();
+};
@@ -0,0 +1,372 @@
+// Самостоятельная игра движка с самим собой для проверки и сбора партий.
+//
+//   selfplay [-g N] [-t N] [-m 1|2|3] [-n узлы | -d глубина] [-r N] [-l N]
+//            [-H МБ] [-s число] [-o архив] [--tb каталог] [-q]
+//
+// Партии раздаются потокам по одной: у каждого потока свой перебор и своя
+// хеш-таблица, у каждой партии своя доска. Режим партии - -m или по кругу 1, 2, 3;
+// первые -r полуходов случайные (генератор зависит только от -s и номера партии,
+// поэтому набор партий не зависит от числа потоков). Партия заканчивается матом,
+// патом, троекратным повторением, правилом 50 ходов, результатом таблиц эндшпиля или лимитом -l
+// полуходов (без результата). Партии по мере готовности дописываются в двоичный
+// архив (GameArchive.h); сводка, партии в секунду и задержка хода - в stderr
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ChessBoard.h"
+#include "GameArchive.h"
+#include "Search.h"
+#include "Tablebase.h"
+#include "TranspositionTable.h"
+
+using namespace std;
+
+namespace {
+
+// Закодированные партии потока сбрасываются в архив порциями не меньше этой
+const size_t FLUSH_BYTES = 64 * 1024;
+
+enum class Ending { MATE, STALEMATE, REPETITION, FIFTY_MOVES, TABLEBASE, MOVE_LIMIT, COUNT };
+
+const char* EndingNames[] = { "мат", "пат", "повторение", "50 ходов", "таблицы", "лимит ходов" };
+
+struct Options {
+    int games = 1000;
+    int threads = max(1, int(thread::hardware_concurrency()));
+    int mode = 0;                 // 0 - режимы 1, 2, 3 по кругу
+    SearchLimits limits;
+    int randomPlies = 8;
+    int maxPlies = 300;
+    size_t hashMb = 4;            // Хеш-таблица каждого потока
+    uint64_t seed = 1;
+    string output = "selfplay.bin";
+    string tbPath = "tb";
+    bool quiet = false;
+};
+
+// Счетчики одного потока
+struct WorkerStats {
+    uint64_t games = 0;
+    uint64_t plies = 0;
+    uint64_t searched = 0;            // Ходы, выбранные перебором
+    uint64_t nodes = 0;
+    uint64_t searchNs = 0;
+    uint64_t endings[int(Ending::COUNT)] = {};
+    uint64_t results[4] = {};         // По GameResult
+    vector<uint32_t> latencyUs;       // Время каждого хода перебора
+
+    void merge(const WorkerStats& other) {
+        games += other.games;
+        plies += other.plies;
+        searched += other.searched;
+        nodes += other.nodes;
+        searchNs += other.searchNs;
+        for (int i = 0; i < int(Ending::COUNT); ++i) {
+            endings[i] += other.endings[i];
+        }
+        for (int i = 0; i < 4; ++i) {
+            results[i] += other.results[i];
+        }
+        latencyUs.insert(latencyUs.end(), other.latencyUs.begin(), other.latencyUs.end());
+    }
+};
+
+// Общее состояние потоков
+struct Shared {
+    const Options* options = nullptr;
+    const Tablebases* tablebases = nullptr;
+    ArchiveWriter* writer = nullptr;
+    mutex writerMutex;
+    atomic<int> nextGame{ 0 };
+    atomic<int> finished{ 0 };
+};
+
+void usage() {
+    cout << "Использование:\n"
+         << "  selfplay [-g N] [-t N] [-m 1|2|3] [-n узлы | -d глубина] [-r N] [-l N]\n"
+         << "           [-H МБ] [-s число] [-o архив] [--tb каталог] [-q]\n";
+}
+
+GameResult winnerResult(Color winner) {
+    return winner == Color::WHITE ? GameResult::WHITE_WINS : GameResult::BLACK_WINS;
+}
+
+Color opponent(Color color) {
+    return color == Color::WHITE ? Color::BLACK : Color::WHITE;
+}
+
+// Итог позиции, если партию пора заканчивать; list - допустимые ходы позиции
+bool adjudicate(const ChessBoard& board, const MoveList& list, const Tablebases* tablebases,
+                Ending& ending, GameResult& result) {
+    Color side = board.sideToMove();
+    if (list.empty()) {
+        if (board.isInCheck(side)) {
+            ending = Ending::MATE;
+            result = winnerResult(opponent(side));
+        }
+        else {
+            ending = Ending::STALEMATE;
+            result = GameResult::DRAW;
+        }
+        return true;
+    }
+    if (board.repetitionCount() >= 2) {
+        ending = Ending::REPETITION;
+        result = GameResult::DRAW;
+        return true;
+    }
+    if (board.halfmoveClock() >= 100) {
+        ending = Ending::FIFTY_MOVES;
+        result = GameResult::DRAW;
+        return true;
+    }
+    TbResult tb;
+    if (tablebases && tablebases->probe(board, tb)) {
+        ending = Ending::TABLEBASE;
+        result = tb.wdl == 0 ? GameResult::DRAW : winnerResult(tb.wdl > 0 ? side : opponent(side));
+        return true;
+    }
+    return false;
+}
+
+// Одна партия от начальной позиции режима до итога; партия дописывается в archive
+void playGame(int index, Search& search, TranspositionTable& table, Shared& shared,
+              WorkerStats& stats, string& archive) {
+    const Options& options = *shared.options;
+    int difficulty = options.mode ? options.mode : index % 3 + 1;
+    mt19937_64 random(options.seed + uint64_t(index) * 0x9E3779B97F4A7C15ull);
+
+    ChessBoard board(difficulty);
+    PackedPosition start;
+    board.pack(start);
+    vector<Move> moves;
+    moves.reserve(options.maxPlies);
+    table.clear();
+    search.clear();
+
+    Ending ending = Ending::MOVE_LIMIT;
+    GameResult result = GameResult::UNKNOWN;
+    MoveList list;
+    for (int ply = 0;; ++ply) {
+        list.clear();
+        board.generateMoves(list);
+        if (adjudicate(board, list, shared.tablebases, ending, result)) {
+            break;
+        }
+        if (ply >= options.maxPlies) {
+            break;
+        }
+
+        Move move;
+        if (ply < options.randomPlies) {
+            move = list[size_t(random() % list.size())];
+        }
+        else {
+            auto begin = chrono::steady_clock::now();
+            SearchResult found = search.run(board, options.limits);
+            uint64_t ns = uint64_t(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - begin).count());
+            move = found.bestMove;
+            ++stats.searched;
+            stats.nodes += found.nodes;
+            stats.searchNs += ns;
+            stats.latencyUs.push_back(uint32_t(min<uint64_t>(ns / 1000, UINT32_MAX)));
+        }
+        board.makeMove(move);
+        moves.push_back(move);
+    }
+
+    ++stats.games;
+    stats.plies += moves.size();
+    ++stats.endings[int(ending)];
+    ++stats.results[int(result)];
+    ArchiveWriter::encodeGame(archive, start, moves.data(), int(moves.size()), result);
+}
+
+void flush(Shared& shared, string& archive) {
+    if (!archive.empty()) {
+        lock_guard<mutex> lock(shared.writerMutex);
+        if (shared.writer) {
+            shared.writer->addEncoded(archive);
+        }
+        archive.clear();
+    }
+}
+
+void worker(Shared& shared, WorkerStats& stats) {
+    const Options& options = *shared.options;
+    TranspositionTable table(options.hashMb);
+    Search search(&table);
+    search.setTablebases(shared.tablebases);
+    string archive;
+
+    for (;;) {
+        int index = shared.nextGame.fetch_add(1, memory_order_relaxed);
+        if (index >= options.games) {
+            break;
+        }
+        playGame(index, search, table, shared, stats, archive);
+        if (archive.size() >= FLUSH_BYTES) {
+            flush(shared, archive);
+        }
+        shared.finished.fetch_add(1, memory_order_relaxed);
+    }
+    flush(shared, archive);
+}
+
+double percentile(vector<uint32_t>& values, double fraction) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    size_t k = min(values.size() - 1, size_t(fraction * double(values.size())));
+    nth_element(values.begin(), values.begin() + ptrdiff_t(k), values.end());
+    return values[k] / 1000.0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    options.limits.nodes = 5000;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "-g") && hasValue) {
+            options.games = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-t") && hasValue) {
+            options.threads = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-m") && hasValue) {
+            options.mode = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-n") && hasValue) {
+            options.limits.nodes = strtoull(argv[++i], nullptr, 10);
+            options.limits.depth = 0;
+        }
+        else if (!strcmp(argv[i], "-d") && hasValue) {
+            options.limits.depth = atoi(argv[++i]);
+            options.limits.nodes = 0;
+        }
+        else if (!strcmp(argv[i], "-r") && hasValue) {
+            options.randomPlies = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-l") && hasValue) {
+            options.maxPlies = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-H") && hasValue) {
+            options.hashMb = size_t(atoi(argv[++i]));
+        }
+        else if (!strcmp(argv[i], "-s") && hasValue) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "-o") && hasValue) {
+            options.output = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--tb") && hasValue) {
+            options.tbPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-q")) {
+            options.quiet = true;
+        }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (options.games < 1 || options.threads < 1 || options.mode < 0 || options.mode > 3
+        || options.randomPlies < 0 || options.maxPlies < 1 || options.maxPlies > UINT16_MAX
+        || options.hashMb < 1 || (options.limits.nodes == 0 && options.limits.depth <= 0)) {
+        usage();
+        return 1;
+    }
+
+    initBitboards();
+
+    Tablebases tablebases;
+    if (!options.tbPath.empty() && tablebases.load(options.tbPath) > 0) {
+        cerr << "Таблицы эндшпиля: " << tablebases.tableCount() << " из " << options.tbPath << "\n";
+    }
+
+    ArchiveWriter writer;
+    if (!writer.open(options.output)) {
+        cerr << "Не удалось создать " << options.output << "\n";
+        return 1;
+    }
+
+    Shared shared;
+    shared.options = &options;
+    shared.tablebases = tablebases.tableCount() ? &tablebases : nullptr;
+    shared.writer = &writer;
+
+    int threadCount = min(options.threads, options.games);
+    vector<WorkerStats> stats(threadCount);
+    vector<thread> threads;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < threadCount; ++i) {
+        threads.emplace_back(worker, ref(shared), ref(stats[i]));
+    }
+
+    // Ход работы - раз в секунду, пока потоки играют
+    double reported = 0.0;
+    while (shared.finished.load(memory_order_relaxed) < options.games) {
+        this_thread::sleep_for(chrono::milliseconds(100));
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (!options.quiet && elapsed - reported >= 1.0) {
+            reported = elapsed;
+            int done = shared.finished.load(memory_order_relaxed);
+            cerr << "\r  партий " << done << "/" << options.games << ", "
+                 << fixed << setprecision(1) << done / elapsed << " в секунду" << flush;
+        }
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (!options.quiet) {
+        cerr << "\r" << string(50, ' ') << "\r";
+    }
+
+    if (!writer.close()) {
+        cerr << "Ошибка записи " << options.output << "\n";
+        return 1;
+    }
+
+    WorkerStats total;
+    for (const WorkerStats& s : stats) {
+        total.merge(s);
+    }
+
+    cerr << fixed << setprecision(1);
+    cerr << "Партий: " << total.games << " в " << options.output << ", полуходов: " << total.plies
+         << ", потоков: " << threadCount << "\n";
+    cerr << "Итоги: 1-0 " << total.results[int(GameResult::WHITE_WINS)]
+         << ", 0-1 " << total.results[int(GameResult::BLACK_WINS)]
+         << ", 1/2 " << total.results[int(GameResult::DRAW)]
+         << ", без результата " << total.results[int(GameResult::UNKNOWN)] << "\n";
+    cerr << "Окончания:";
+    for (int i = 0; i < int(Ending::COUNT); ++i) {
+        cerr << (i ? ", " : " ") << EndingNames[i] << " " << total.endings[i];
+    }
+    cerr << "\n";
+
+    double average = total.searched ? total.searchNs / 1e6 / double(total.searched) : 0.0;
+    double nps = total.searchNs ? total.nodes * 1e9 / double(total.searchNs) : 0.0;
+    cerr << "Время: " << setprecision(2) << seconds << " с, " << setprecision(1)
+         << total.games / seconds << " партий в секунду, " << total.plies / seconds << " полуходов в секунду\n";
+    cerr << "Ход перебора: в среднем " << setprecision(3) << average << " мс, медиана "
+         << percentile(total.latencyUs, 0.5) << " мс, 99% " << percentile(total.latencyUs, 0.99)
+         << " мс, " << setprecision(0) << nps << " узлов/с на поток\n";
+    return 0;
+}
@@ -0,0 +1,836 @@
+// Сервер партий: тысячи независимых партий в одном процессе (только Linux).
+//
+//   server [-p порт | -u путь] [-t N] [-s N]
+//
+// Протокол - в ServerProtocol.h. Главный поток ведет цикл событий epoll: принимает
+// соединения на 127.0.0.1:порт (или на Unix-сокете -u), читает строки запросов и
+// отправляет ответы. Партии живут в пуле из -s сессий, созданном при запуске: новая
+// партия берет свободную сессию и копирует в ее доску заготовку уровня, поэтому
+// создание и удаление партий не выделяют память. Ходы проверяются и выполняются в
+// -t рабочих потоках; сессия закреплена за потоком (индекс по модулю -t), так что
+// ее доску трогает только он и запросы к одной партии выполняются по порядку.
+// Готовые ответы потоки складывают в общую очередь и будят цикл через eventfd.
+// SIGINT и SIGTERM останавливают сервер; сводка выводится в stderr
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "ChessBoard.h"
+#include "ServerProtocol.h"
+
+using namespace std;
+
+namespace {
+
+const uint32_t NONE = UINT32_MAX;
+
+// Метки событий epoll для слушающего сокета и eventfd; у соединений - номер и дескриптор
+const uint64_t LISTEN_EVENT = UINT64_MAX;
+const uint64_t WAKE_EVENT = UINT64_MAX - 1;
+
+const int MAX_EVENTS = 256;
+
+volatile sig_atomic_t stopRequested = 0;
+
+void onSignal(int) {
+    stopRequested = 1;
+}
+
+struct Options {
+    int port = DEFAULT_SERVER_PORT;
+    string unixPath;
+    int threads = max(1, int(thread::hardware_concurrency()));
+    uint32_t sessions = 4096;
+};
+
+void usage() {
+    cout << "Использование:\n"
+         << "  server [-p порт | -u путь] [-t N] [-s N]\n";
+}
+
+// Номер партии: поколение сессии и ее индекс в пуле. Поколение растет при каждом
+// освобождении, поэтому номер закончившейся партии не попадет в следующую
+uint64_t sessionId(uint32_t index, uint32_t generation) {
+    return (uint64_t(generation) << 32) | index;
+}
+
+// Сессия пула
+struct Session {
+    // Доску и итог трогает только рабочий поток сессии
+    ChessBoard board;
+    char result = RESULT_ONGOING;
+
+    // Остальное - только цикл событий
+    uint32_t generation = 0;
+    uint32_t owner = NONE;        // Соединение-владелец (NONE - свободна или заканчивается)
+    uint32_t prevOwned = NONE;    // Двусвязный список партий соединения
+    uint32_t nextOwned = NONE;
+};
+
+// Пул сессий фиксированного размера со стеком свободных
+class SessionArena {
+private:
+    vector<Session> sessions;
+    vector<uint32_t> freeList;
+
+public:
+    explicit SessionArena(uint32_t capacity) : sessions(capacity) {
+        freeList.reserve(capacity);
+        for (uint32_t i = capacity; i > 0; --i) {
+            freeList.push_back(i - 1);
+        }
+    }
+
+    // Свободная сессия (NONE, если заняты все)
+    uint32_t allocate() {
+        if (freeList.empty()) {
+            return NONE;
+        }
+        uint32_t index = freeList.back();
+        freeList.pop_back();
+        return index;
+    }
+
+    void release(uint32_t index) {
+        ++sessions[index].generation;
+        freeList.push_back(index);
+    }
+
+    // Индекс сессии живой партии id (NONE, если партия закончилась или номера нет)
+    uint32_t find(uint64_t id) const {
+        uint32_t index = uint32_t(id);
+        if (index >= sessions.size() || sessions[index].generation != uint32_t(id >> 32)) {
+            return NONE;
+        }
+        return index;
+    }
+
+    Session& operator[](uint32_t index) {
+        return sessions[index];
+    }
+
+    uint32_t capacity() const {
+        return uint32_t(sessions.size());
+    }
+
+    uint32_t active() const {
+        return uint32_t(sessions.size() - freeList.size());
+    }
+};
+
+enum class JobType : uint8_t { NEW, MOVE, FEN, END };
+
+// Запрос к партии для рабочего потока
+struct Job {
+    JobType type = JobType::MOVE;
+    uint8_t mode = 3;             // Уровень новой партии
+    uint32_t session = NONE;
+    uint32_t conn = NONE;         // Соединение для ответа (NONE - ответ не нужен)
+    uint32_t connSerial = 0;
+    uint64_t id = 0;
+    char text[16] = {};           // Ход или метка новой партии
+};
+
+// Ответ рабочего потока
+struct Reply {
+    uint32_t conn = NONE;
+    uint32_t connSerial = 0;
+    uint32_t released = NONE;     // Сессия, которую цикл событий возвращает в пул
+    uint32_t length = 0;
+    char text[128];
+};
+
+// Итог партии после хода
+char moveResult(const ChessBoard& board) {
+    Color side = board.sideToMove();
+    if (board.isCheckmate(side)) {
+        return RESULT_MATE;
+    }
+    if (board.isStalemate(side) || board.isDrawByRule()) {
+        return RESULT_DRAW;
+    }
+    return RESULT_ONGOING;
+}
+
+// Рабочие потоки: у каждого своя очередь запросов, ответы - в общую очередь
+class WorkerPool {
+private:
+    struct Queue {
+        mutex lock;
+        condition_variable ready;
+        vector<Job> jobs;
+        bool stopping = false;
+        uint64_t moves = 0;       // Выполненные ходы (читается после остановки)
+    };
+
+    SessionArena& arena;
+    const ChessBoard* setups;
+    int wakeFd;
+    vector<unique_ptr<Queue>> queues;
+    vector<thread> threads;
+
+    mutex doneLock;
+    vector<Reply> done;
+
+    void run(Queue& queue) {
+        vector<Job> jobs;
+        vector<Reply> replies;
+        for (;;) {
+            {
+                unique_lock<mutex> guard(queue.lock);
+                queue.ready.wait(guard, [&] { return queue.stopping || !queue.jobs.empty(); });
+                if (queue.jobs.empty()) {
+                    return;
+                }
+                swap(jobs, queue.jobs);
+            }
+
+            for (const Job& job : jobs) {
+                Reply reply;
+                execute(job, reply, queue);
+                if (reply.conn != NONE || reply.released != NONE) {
+                    replies.push_back(reply);
+                }
+            }
+            jobs.clear();
+            publish(replies);
+            replies.clear();
+        }
+    }
+
+    void execute(const Job& job, Reply& reply, Queue& queue) {
+        Session& session = arena[job.session];
+        unsigned long long id = job.id;
+        reply.conn = job.conn;
+        reply.connSerial = job.connSerial;
+
+        int length = 0;
+        switch (job.type) {
+        case JobType::NEW:
+            // Копия заготовки не выделяет память: стек отмены сессии уже зарезервирован
+            session.board = setups[job.mode - 1];
+            session.result = RESULT_ONGOING;
+            length = job.text[0] ? snprintf(reply.text, sizeof(reply.text), "G %llu %s\n", id, job.text)
+                                 : snprintf(reply.text, sizeof(reply.text), "G %llu\n", id);
+            break;
+        case JobType::MOVE: {
+            if (session.result != RESULT_ONGOING) {
+                length = snprintf(reply.text, sizeof(reply.text), "ER %llu over\n", id);
+                break;
+            }
+            Move move = session.board.parseMove(job.text);
+            if (move == MOVE_NONE) {
+                length = snprintf(reply.text, sizeof(reply.text), "ER %llu illegal\n", id);
+                break;
+            }
+            session.board.makeMove(move);
+            session.result = moveResult(session.board);
+            ++queue.moves;
+            length = snprintf(reply.text, sizeof(reply.text), "OK %llu %c\n", id, session.result);
+            break;
+        }
+        case JobType::FEN:
+            length = snprintf(reply.text, sizeof(reply.text), "P %llu %s\n", id, session.board.toFen().c_str());
+            break;
+        case JobType::END:
+            reply.released = job.session;
+            length = snprintf(reply.text, sizeof(reply.text), "X %llu\n", id);
+            break;
+        }
+        reply.length = uint32_t(min(max(length, 0), int(sizeof(reply.text)) - 1));
+    }
+
+    // Ответы в общую очередь; цикл будится, только если очередь была пуста
+    void publish(const vector<Reply>& replies) {
+        if (replies.empty()) {
+            return;
+        }
+        bool wasEmpty;
+        {
+            lock_guard<mutex> guard(doneLock);
+            wasEmpty = done.empty();
+            done.insert(done.end(), replies.begin(), replies.end());
+        }
+        if (wasEmpty) {
+            uint64_t one = 1;
+            ssize_t written = write(wakeFd, &one, sizeof(one));
+            (void)written;
+        }
+    }
+
+public:
+    WorkerPool(int count, SessionArena& sessions, const ChessBoard* setupBoards, int eventFd)
+        : arena(sessions), setups(setupBoards), wakeFd(eventFd) {
+        for (int i = 0; i < count; ++i) {
+            queues.push_back(make_unique<Queue>());
+        }
+        for (int i = 0; i < count; ++i) {
+            threads.emplace_back(&WorkerPool::run, this, ref(*queues[i]));
+        }
+    }
+
+    ~WorkerPool() {
+        stop();
+    }
+
+    // Поток, за которым закреплена сессия
+    uint32_t workerOf(uint32_t session) const {
+        return session % uint32_t(queues.size());
+    }
+
+    size_t size() const {
+        return queues.size();
+    }
+
+    // Передача накопленных запросов потоку; batch очищается
+    void submit(uint32_t worker, vector<Job>& batch) {
+        Queue& queue = *queues[worker];
+        bool wasEmpty;
+        {
+            lock_guard<mutex> guard(queue.lock);
+            wasEmpty = queue.jobs.empty();
+            queue.jobs.insert(queue.jobs.end(), batch.begin(), batch.end());
+        }
+        if (wasEmpty) {
+            queue.ready.notify_one();
+        }
+        batch.clear();
+    }
+
+    // Готовые ответы (out заменяется содержимым очереди)
+    void takeReplies(vector<Reply>& out) {
+        out.clear();
+        lock_guard<mutex> guard(doneLock);
+        swap(out, done);
+    }
+
+    // Остановка после выполнения уже принятых запросов
+    void stop() {
+        for (unique_ptr<Queue>& queue : queues) {
+            lock_guard<mutex> guard(queue->lock);
+            queue->stopping = true;
+            queue->ready.notify_one();
+        }
+        for (thread& t : threads) {
+            t.join();
+        }
+        threads.clear();
+    }
+
+    uint64_t moves() const {
+        uint64_t total = 0;
+        for (const unique_ptr<Queue>& queue : queues) {
+            total += queue->moves;
+        }
+        return total;
+    }
+};
+
+// Соединение; индекс в таблице соединений - его дескриптор
+struct Connection {
+    int fd = -1;
+    uint32_t serial = 0;          // Отличает соединения с одним и тем же дескриптором
+    string input;                 // Непрочитанный остаток запросов
+    string output;                // Неотправленные ответы
+    uint32_t ownedHead = NONE;    // Список партий соединения
+    bool writing = false;         // Ждем EPOLLOUT
+    bool dirty = false;           // Есть новые ответы, соединение в списке на отправку
+    bool closing = false;         // Пришел запрос Q
+};
+
+int openListener(const Options& options) {
+    int fd;
+    if (!options.unixPath.empty()) {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (options.unixPath.size() >= sizeof(addr.sun_path)) {
+            cerr << "Слишком длинный путь сокета: " << options.unixPath << "\n";
+            return -1;
+        }
+        memcpy(addr.sun_path, options.unixPath.c_str(), options.unixPath.size() + 1);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        unlink(options.unixPath.c_str());
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            perror("bind");
+            return -1;
+        }
+    }
+    else {
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(uint16_t(options.port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int yes = 1;
+        if (fd < 0 || setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes)) < 0
+            || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            perror("bind");
+            return -1;
+        }
+    }
+    if (listen(fd, SOMAXCONN) < 0) {
+        perror("listen");
+        return -1;
+    }
+    return fd;
+}
+
+class GameServer {
+private:
+    const Options& options;
+    int epollFd;
+    int listenFd;
+    int wakeFd;
+    ChessBoard setups[3];
+    SessionArena arena;
+    WorkerPool pool;
+
+    vector<Connection> connections;
+    vector<vector<Job>> batches;      // Запросы цикла, еще не переданные потокам
+    vector<uint32_t> dirty;           // Соединения с новыми ответами
+    vector<Reply> replies;
+    uint32_t nextSerial = 1;
+
+    uint64_t accepted = 0;
+    uint64_t created = 0;
+    uint32_t peakSessions = 0;
+
+    static uint64_t eventTag(const Connection& c) {
+        return (uint64_t(c.serial) << 32) | uint32_t(c.fd);
+    }
+
+    void watch(Connection& c, uint32_t events, int op) {
+        epoll_event ev = {};
+        ev.events = events;
+        ev.data.u64 = eventTag(c);
+        epoll_ctl(epollFd, op, c.fd, &ev);
+    }
+
+    void markDirty(Connection& c) {
+        if (!c.dirty) {
+            c.dirty = true;
+            dirty.push_back(uint32_t(c.fd));
+        }
+    }
+
+    void send(Connection& c, const char* text, size_t length) {
+        c.output.append(text, length);
+        markDirty(c);
+    }
+
+    void error(Connection& c, string_view id, const char* reason) {
+        char text[64];
+        int length = snprintf(text, sizeof(text), "ER %.*s %s\n", int(min<size_t>(id.size(), 24)), id.data(), reason);
+        send(c, text, size_t(length));
+    }
+
+    // Запрос в очередь потока сессии (передается потокам после обработки событий)
+    Job& submit(JobType type, uint32_t session, const Connection* c, uint64_t id, string_view text = string_view()) {
+        Job job;
+        job.type = type;
+        job.session = session;
+        job.conn = c ? uint32_t(c->fd) : NONE;
+        job.connSerial = c ? c->serial : 0;
+        job.id = id;
+        memcpy(job.text, text.data(), min(text.size(), sizeof(job.text) - 1));
+        vector<Job>& batch = batches[pool.workerOf(session)];
+        batch.push_back(job);
+        return batch.back();
+    }
+
+    void link(Connection& c, uint32_t index) {
+        Session& s = arena[index];
+        s.owner = uint32_t(c.fd);
+        s.prevOwned = NONE;
+        s.nextOwned = c.ownedHead;
+        if (c.ownedHead != NONE) {
+            arena[c.ownedHead].prevOwned = index;
+        }
+        c.ownedHead = index;
+    }
+
+    void unlink(Connection& c, uint32_t index) {
+        Session& s = arena[index];
+        if (s.prevOwned != NONE) {
+            arena[s.prevOwned].nextOwned = s.nextOwned;
+        }
+        else {
+            c.ownedHead = s.nextOwned;
+        }
+        if (s.nextOwned != NONE) {
+            arena[s.nextOwned].prevOwned = s.prevOwned;
+        }
+        s.owner = NONE;
+        s.prevOwned = s.nextOwned = NONE;
+    }
+
+    void newGame(Connection& c, string_view line) {
+        string_view modeField = nextField(line);
+        string_view tag = nextField(line);
+        uint64_t mode = 3;
+        if ((!modeField.empty() && (!parseNumber(modeField, mode) || mode < 1 || mode > 3))
+            || tag.size() >= sizeof(Job::text)) {
+            error(c, "-", "bad");
+            return;
+        }
+        uint32_t index = arena.allocate();
+        if (index == NONE) {
+            error(c, "-", "full");
+            return;
+        }
+        link(c, index);
+        submit(JobType::NEW, index, &c, sessionId(index, arena[index].generation), tag).mode = uint8_t(mode);
+        ++created;
+        peakSessions = max(peakSessions, arena.active());
+    }
+
+    void handleLine(Connection& c, string_view line) {
+        string_view command = nextField(line);
+        if (command == "N") {
+            newGame(c, line);
+            return;
+        }
+        if (command == "Q") {
+            c.closing = true;
+            return;
+        }
+        if (command != "M" && command != "F" && command != "E") {
+            if (!command.empty()) {
+                error(c, "-", "bad");
+            }
+            return;
+        }
+
+        string_view idField = nextField(line);
+        uint64_t id = 0;
+        if (!parseNumber(idField, id)) {
+            error(c, "-", "bad");
+            return;
+        }
+        uint32_t index = arena.find(id);
+        if (index == NONE || arena[index].owner != uint32_t(c.fd)) {
+            error(c, idField, "unknown");
+            return;
+        }
+
+        if (command == "M") {
+            string_view move = nextField(line);
+            if (move.empty() || move.size() >= sizeof(Job::text)) {
+                error(c, idField, "bad");
+                return;
+            }
+            submit(JobType::MOVE, index, &c, id, move);
+        }
+        else if (command == "F") {
+            submit(JobType::FEN, index, &c, id);
+        }
+        else {
+            // Сессия возвращается в пул, когда ее поток выполнит все запросы к ней
+            unlink(c, index);
+            submit(JobType::END, index, &c, id);
+        }
+    }
+
+    void closeConnection(Connection& c) {
+        for (uint32_t index = c.ownedHead; index != NONE;) {
+            uint32_t next = arena[index].nextOwned;
+            arena[index].owner = NONE;
+            arena[index].prevOwned = arena[index].nextOwned = NONE;
+            submit(JobType::END, index, nullptr, sessionId(index, arena[index].generation));
+            index = next;
+        }
+        c.ownedHead = NONE;
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, c.fd, nullptr);
+        close(c.fd);
+        c.fd = -1;
+        c.input.clear();
+        c.output.clear();
+        c.writing = c.closing = false;
+    }
+
+    void acceptConnections() {
+        for (;;) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            if (options.unixPath.empty()) {
+                int yes = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+            }
+            if (size_t(fd) >= connections.size()) {
+                connections.resize(size_t(fd) + 1);
+            }
+            Connection& c = connections[size_t(fd)];
+            c.fd = fd;
+            c.serial = nextSerial++;
+            c.dirty = false;
+            watch(c, EPOLLIN | EPOLLRDHUP, EPOLL_CTL_ADD);
+            ++accepted;
+        }
+    }
+
+    void readConnection(Connection& c) {
+        char buffer[16384];
+        for (;;) {
+            ssize_t n = recv(c.fd, buffer, sizeof(buffer), 0);
+            if (n > 0) {
+                c.input.append(buffer, size_t(n));
+                if (size_t(n) < sizeof(buffer)) {
+                    break;
+                }
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            closeConnection(c);
+            return;
+        }
+
+        size_t pos = 0;
+        while (!c.closing) {
+            size_t end = c.input.find('\n', pos);
+            if (end == string::npos) {
+                break;
+            }
+            string_view line(c.input.data() + pos, end - pos);
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            handleLine(c, line);
+            pos = end + 1;
+        }
+        c.input.erase(0, pos);
+        if (c.closing || c.input.size() > MAX_REQUEST_LINE) {
+            closeConnection(c);
+        }
+    }
+
+    void flush(Connection& c) {
+        while (!c.output.empty()) {
+            ssize_t n = ::send(c.fd, c.output.data(), c.output.size(), MSG_NOSIGNAL);
+            if (n > 0) {
+                c.output.erase(0, size_t(n));
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (!c.writing) {
+                    c.writing = true;
+                    watch(c, EPOLLIN | EPOLLRDHUP | EPOLLOUT, EPOLL_CTL_MOD);
+                }
+                return;
+            }
+            closeConnection(c);
+            return;
+        }
+        if (c.writing) {
+            c.writing = false;
+            watch(c, EPOLLIN | EPOLLRDHUP, EPOLL_CTL_MOD);
+        }
+    }
+
+    void collectReplies() {
+        uint64_t count;
+        ssize_t got = read(wakeFd, &count, sizeof(count));
+        (void)got;
+        pool.takeReplies(replies);
+        for (const Reply& reply : replies) {
+            if (reply.released != NONE) {
+                arena.release(reply.released);
+            }
+            if (reply.conn == NONE || reply.conn >= connections.size()) {
+                continue;
+            }
+            Connection& c = connections[reply.conn];
+            if (c.fd >= 0 && c.serial == reply.connSerial) {
+                send(c, reply.text, reply.length);
+            }
+        }
+    }
+
+    void submitBatches() {
+        for (size_t w = 0; w < batches.size(); ++w) {
+            if (!batches[w].empty()) {
+                pool.submit(uint32_t(w), batches[w]);
+            }
+        }
+    }
+
+    void flushDirty() {
+        for (uint32_t fd : dirty) {
+            Connection& c = connections[fd];
+            c.dirty = false;
+            if (c.fd >= 0) {
+                flush(c);
+            }
+        }
+        dirty.clear();
+    }
+
+public:
+    GameServer(const Options& opts, int epoll, int listener, int eventFd)
+        : options(opts), epollFd(epoll), listenFd(listener), wakeFd(eventFd),
+          setups{ ChessBoard(1), ChessBoard(2), ChessBoard(3) }, arena(opts.sessions),
+          pool(opts.threads, arena, setups, eventFd), batches(size_t(opts.threads)) {
+    }
+
+    void run() {
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.u64 = LISTEN_EVENT;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+        ev.data.u64 = WAKE_EVENT;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+
+        epoll_event events[MAX_EVENTS];
+        while (!stopRequested) {
+            int n = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                perror("epoll_wait");
+                break;
+            }
+            for (int i = 0; i < n; ++i) {
+                uint64_t tag = events[i].data.u64;
+                if (tag == LISTEN_EVENT) {
+                    acceptConnections();
+                    continue;
+                }
+                if (tag == WAKE_EVENT) {
+                    collectReplies();
+                    continue;
+                }
+                // Событие могло прийти для уже закрытого соединения с тем же дескриптором
+                size_t fd = size_t(uint32_t(tag));
+                Connection& c = connections[fd];
+                if (c.fd < 0 || c.serial != uint32_t(tag >> 32)) {
+                    continue;
+                }
+                if (events[i].events & EPOLLIN) {
+                    readConnection(c);
+                }
+                if (c.fd >= 0 && (events[i].events & EPOLLOUT)) {
+                    flush(c);
+                }
+                if (c.fd >= 0 && (events[i].events & (EPOLLERR | EPOLLHUP))) {
+                    closeConnection(c);
+                }
+            }
+            submitBatches();
+            flushDirty();
+        }
+
+        for (Connection& c : connections) {
+            if (c.fd >= 0) {
+                closeConnection(c);
+            }
+        }
+        submitBatches();
+        pool.stop();
+    }
+
+    void printSummary() const {
+        cerr << "Соединений: " << accepted << ", партий: " << created << ", ходов: " << pool.moves()
+             << ", одновременно партий не больше " << peakSessions << " из " << arena.capacity() << "\n";
+    }
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "-p") && hasValue) {
+            options.port = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-u") && hasValue) {
+            options.unixPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-t") && hasValue) {
+            options.threads = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-s") && hasValue) {
+            options.sessions = uint32_t(strtoul(argv[++i], nullptr, 10));
+        }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (options.port < 1 || options.port > 65535 || options.threads < 1 || options.sessions < 1
+        || options.sessions > (1u << 24)) {
+        usage();
+        return 1;
+    }
+
+    initBitboards();
+
+    struct sigaction action = {};
+    action.sa_handler = onSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    int listenFd = openListener(options);
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    int wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (listenFd < 0 || epollFd < 0 || wakeFd < 0) {
+        return 1;
+    }
+
+    GameServer server(options, epollFd, listenFd, wakeFd);
+    if (options.unixPath.empty()) {
+        cerr << "Сервер партий: 127.0.0.1:" << options.port;
+    }
+    else {
+        cerr << "Сервер партий: " << options.unixPath;
+    }
+    cerr << ", сессий " << options.sessions << ", рабочих потоков " << options.threads << "\n";
+
+    server.run();
+    server.printSummary();
+
+    close(wakeFd);
+    close(epollFd);
+    close(listenFd);
+    if (!options.unixPath.empty()) {
+        unlink(options.unixPath.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// Текстовый протокол сервера партий (server и loadgen): запрос и ответ - по строке
+// с '\n' в конце, поля через пробел. Запросы одного соединения к разным партиям
+// выполняются параллельно, поэтому ответы на них могут прийти в другом порядке;
+// запросы к одной партии выполняются и отвечаются по порядку.
+//
+//   N [уровень] [метка]   -> G <id> [метка]   новая партия из начальной расстановки
+//                                             уровня 1-3 (по умолчанию 3); метка
+//                                             возвращается как есть
+//   M <id> <ход>          -> OK <id> <итог>   ход в координатной нотации ("e2e4",
+//                                             "e7e8q"); итог: * - партия продолжается,
+//                                             # - мат, = - пат или ничья по правилам
+//   F <id>                -> P <id> <FEN>     текущая позиция
+//   E <id>                -> X <id>           конец партии, сессия освобождается
+//   Q                                         закрыть соединение
+//
+// Ошибка: ER <id или -> <причина>: unknown - нет такой партии у этого соединения,
+// illegal - недопустимый ход, over - партия уже окончена, full - нет свободных
+// сессий, bad - неверный запрос. Партии соединения заканчиваются при его закрытии
+
+const int DEFAULT_SERVER_PORT = 7070;
+
+// Длиннее строка запроса быть не может: соединение с такой строкой закрывается
+const size_t MAX_REQUEST_LINE = 256;
+
+// Итоги хода в ответе OK
+const char RESULT_ONGOING = '*';
+const char RESULT_MATE = '#';
+const char RESULT_DRAW = '=';
+
+// Очередное поле строки (пустое, если полей больше нет); line укорачивается
+inline std::string_view nextField(std::string_view& line) {
+    size_t start = line.find_first_not_of(' ');
+    if (start == std::string_view::npos) {
+        line = std::string_view();
+        return line;
+    }
+    size_t end = line.find(' ', start);
+    if (end == std::string_view::npos) {
+        end = line.size();
+    }
+    std::string_view field = line.substr(start, end - start);
+    line.remove_prefix(end);
+    return field;
+}
+
+// Разбор номера партии или другого десятичного числа (false - не число)
+inline bool parseNumber(std::string_view field, uint64_t& value) {
+    if (field.empty() || field.size() > 19) {
+        return false;
+    }
+    value = 0;
+    for (char c : field) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + uint64_t(c - '0');
+    }
+    return true;
+}
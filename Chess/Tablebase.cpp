@@ -0,0 +1,428 @@
+#include "Tablebase.h"
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+
+namespace {
+
+const char PieceLetters[] = "KQRBNP";
+
+// Перевес одной стороны по материалу: сумма MaterialMg фигур без короля
+int materialValue(const TbMaterial& material, int color) {
+    int value = 0;
+    for (int i = 2; i < material.count; ++i) {
+        if (material.color[i] == color) {
+            value += MaterialMg[int(material.type[i])];
+        }
+    }
+    return value;
+}
+
+std::string sideLetters(const TbMaterial& material, int color) {
+    std::string letters;
+    for (int i = 2; i < material.count; ++i) {
+        if (material.color[i] == color) {
+            letters += PieceLetters[int(material.type[i])];
+        }
+    }
+    return letters;
+}
+
+// Клетки фигур доски в порядке набора: короли, затем фигуры белых и черных
+// по типам, одинаковые фигуры - по возрастанию клеток
+void boardSquares(const ChessBoard& board, int* squares) {
+    squares[0] = lsb(board.piecesOf(Color::WHITE, PieceType::KING));
+    squares[1] = lsb(board.piecesOf(Color::BLACK, PieceType::KING));
+    int n = 2;
+    for (Color color : { Color::WHITE, Color::BLACK }) {
+        for (int t = int(PieceType::QUEEN); t <= int(PieceType::PAWN); ++t) {
+            Bitboard b = board.piecesOf(color, PieceType(t));
+            while (b) {
+                squares[n++] = popLsb(b);
+            }
+        }
+    }
+}
+
+// Число клеток, на которых может стоять фигура типа type (пешка - не на крайних
+// горизонталях), и номер клетки sq среди них (-1 - фигура там стоять не может)
+int slotCount(PieceType type) {
+    return type == PieceType::PAWN ? 48 : 64;
+}
+
+int slotOf(PieceType type, int sq) {
+    if (type != PieceType::PAWN) {
+        return sq;
+    }
+    return (rankOf(sq) == 0 || rankOf(sq) == 7) ? -1 : sq - 8;
+}
+
+int slotSquare(PieceType type, int slot) {
+    return type == PieceType::PAWN ? slot + 8 : slot;
+}
+
+// Фигура i набора и следующая - одинаковые (пишутся одной парой)
+bool pairedWithNext(const TbMaterial& material, int i) {
+    return i + 1 < material.count && material.type[i] == material.type[i + 1]
+        && material.color[i] == material.color[i + 1];
+}
+
+// Пара разных номеров a < b: b * (b - 1) / 2 + a
+size_t pairCount(int slots) {
+    return size_t(slots) * size_t(slots - 1) / 2;
+}
+
+void pairSlots(size_t code, int& a, int& b) {
+    b = int((1.0 + std::sqrt(1.0 + 8.0 * double(code))) / 2.0);
+    while (size_t(b) * size_t(b - 1) / 2 > code) {
+        --b;
+    }
+    while (size_t(b + 1) * size_t(b) / 2 <= code) {
+        ++b;
+    }
+    a = int(code - size_t(b) * size_t(b - 1) / 2);
+}
+
+// Клеток белого короля: половина доски (с пешками) или треугольник a1-d1-d4
+int kingSlots(bool pawns) {
+    return pawns ? 32 : 10;
+}
+
+int kingSlot(bool pawns, int sq) {
+    int file = fileOf(sq);
+    int rank = rankOf(sq);
+    return pawns ? rank * 4 + file : file * (file + 1) / 2 + rank;
+}
+
+int kingSquare(bool pawns, int slot) {
+    if (pawns) {
+        return makeSquare(slot % 4, slot / 4);
+    }
+    int file = 0;
+    while ((file + 1) * (file + 2) / 2 <= slot) {
+        ++file;
+    }
+    return makeSquare(file, slot - file * (file + 1) / 2);
+}
+
+// Симметричная позиция, в которой белый король стоит в записываемой части доски:
+// отражение по вертикали, а без пешек еще по горизонтали и относительно диагонали a1-h8
+void normalizeSquares(const TbMaterial& material, bool pawns, const int* squares, int* out) {
+    int mirror = 0;
+    if (fileOf(squares[0]) > 3) {
+        mirror ^= 7;
+    }
+    if (!pawns && rankOf(squares[0]) > 3) {
+        mirror ^= 56;
+    }
+    int king = squares[0] ^ mirror;
+    bool transpose = !pawns && rankOf(king) > fileOf(king);
+    for (int i = 0; i < material.count; ++i) {
+        int sq = squares[i] ^ mirror;
+        out[i] = transpose ? makeSquare(rankOf(sq), fileOf(sq)) : sq;
+    }
+}
+
+} // namespace
+
+bool TbMaterial::parse(const std::string& name, TbMaterial& out) {
+    if (name.size() < 2 || name[0] != 'K') {
+        return false;
+    }
+    size_t second = name.find('K', 1);
+    if (second == std::string::npos || name.find('K', second + 1) != std::string::npos
+        || name.size() > TB_MAX_PIECES) {
+        return false;
+    }
+
+    TbMaterial m;
+    m.count = 2;
+    m.type[0] = m.type[1] = PieceType::KING;
+    m.color[0] = 0;
+    m.color[1] = 1;
+    for (int color = 0; color < 2; ++color) {
+        std::string letters = (color == 0) ? name.substr(1, second - 1) : name.substr(second + 1);
+        // Фигуры стороны - в порядке PieceType
+        for (int t = int(PieceType::QUEEN); t <= int(PieceType::PAWN); ++t) {
+            for (char c : letters) {
+                if (c == PieceLetters[t]) {
+                    m.type[m.count] = PieceType(t);
+                    m.color[m.count] = color;
+                    ++m.count;
+                }
+            }
+        }
+        for (char c : letters) {
+            if (c == 'K' || !strchr(PieceLetters, c)) {
+                return false;
+            }
+        }
+    }
+    out = m;
+    return true;
+}
+
+bool TbMaterial::fromBoard(const ChessBoard& board, TbMaterial& out) {
+    if (popCount(board.occupied()) > TB_MAX_PIECES
+        || popCount(board.piecesOf(Color::WHITE, PieceType::KING)) != 1
+        || popCount(board.piecesOf(Color::BLACK, PieceType::KING)) != 1) {
+        return false;
+    }
+
+    TbMaterial m;
+    m.count = 2;
+    m.type[0] = m.type[1] = PieceType::KING;
+    m.color[0] = 0;
+    m.color[1] = 1;
+    for (int color = 0; color < 2; ++color) {
+        for (int t = int(PieceType::QUEEN); t <= int(PieceType::PAWN); ++t) {
+            int n = popCount(board.piecesOf(color == 0 ? Color::WHITE : Color::BLACK, PieceType(t)));
+            for (int i = 0; i < n; ++i) {
+                m.type[m.count] = PieceType(t);
+                m.color[m.count] = color;
+                ++m.count;
+            }
+        }
+    }
+    out = m;
+    return true;
+}
+
+std::string TbMaterial::name() const {
+    return "K" + sideLetters(*this, 0) + "K" + sideLetters(*this, 1);
+}
+
+uint32_t TbMaterial::key() const {
+    uint32_t k = 0;
+    for (int i = 2; i < count; ++i) {
+        k += 1u << (3 * (color[i] * 5 + int(type[i]) - 1));
+    }
+    return k;
+}
+
+bool TbMaterial::isCanonical() const {
+    int white = materialValue(*this, 0);
+    int black = materialValue(*this, 1);
+    if (white != black) {
+        return white > black;
+    }
+    return sideLetters(*this, 0) >= sideLetters(*this, 1);
+}
+
+TbMaterial TbMaterial::flipped() const {
+    TbMaterial m = *this;
+    int n = 2;
+    for (int side = 1; side >= 0; --side) {
+        for (int i = 2; i < count; ++i) {
+            if (color[i] == side) {
+                m.type[n] = type[i];
+                m.color[n] = side ^ 1;
+                ++n;
+            }
+        }
+    }
+    return m;
+}
+
+bool TbMaterial::hasPawns() const {
+    for (int i = 2; i < count; ++i) {
+        if (type[i] == PieceType::PAWN) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t TbMaterial::entryCount() const {
+    size_t entries = size_t(2) * size_t(kingSlots(hasPawns())) * 64;
+    for (int i = 2; i < count; ++i) {
+        int slots = slotCount(type[i]);
+        if (pairedWithNext(*this, i)) {
+            entries *= pairCount(slots);
+            ++i;
+        }
+        else {
+            entries *= size_t(slots);
+        }
+    }
+    return entries;
+}
+
+size_t tbIndex(const TbMaterial& material, int stm, const int* squares) {
+    bool pawns = material.hasPawns();
+    int sq[TB_MAX_PIECES];
+    normalizeSquares(material, pawns, squares, sq);
+
+    size_t index = size_t(stm) * size_t(kingSlots(pawns)) + size_t(kingSlot(pawns, sq[0]));
+    index = index * 64 + size_t(sq[1]);
+    for (int i = 2; i < material.count; ++i) {
+        int slots = slotCount(material.type[i]);
+        int a = slotOf(material.type[i], sq[i]);
+        if (a < 0) {
+            return TB_NO_INDEX;
+        }
+        if (!pairedWithNext(material, i)) {
+            index = index * size_t(slots) + size_t(a);
+            continue;
+        }
+        int b = slotOf(material.type[i], sq[i + 1]);
+        if (b < 0 || a == b) {
+            return TB_NO_INDEX;
+        }
+        if (a > b) {
+            std::swap(a, b);
+        }
+        index = index * pairCount(slots) + size_t(b) * size_t(b - 1) / 2 + size_t(a);
+        ++i;
+    }
+    return index;
+}
+
+void tbPosition(const TbMaterial& material, size_t index, int& stm, int* squares) {
+    // Группы фигур в порядке записи (одна фигура или пара одинаковых);
+    // номер разбирается с конца, с последней группы
+    int first[TB_MAX_PIECES];
+    int groups = 0;
+    for (int i = 2; i < material.count; ++i) {
+        first[groups++] = i;
+        if (pairedWithNext(material, i)) {
+            ++i;
+        }
+    }
+    for (int g = groups - 1; g >= 0; --g) {
+        int i = first[g];
+        PieceType type = material.type[i];
+        int slots = slotCount(type);
+        if (pairedWithNext(material, i)) {
+            int a, b;
+            pairSlots(index % pairCount(slots), a, b);
+            index /= pairCount(slots);
+            squares[i] = slotSquare(type, a);
+            squares[i + 1] = slotSquare(type, b);
+        }
+        else {
+            squares[i] = slotSquare(type, int(index % size_t(slots)));
+            index /= size_t(slots);
+        }
+    }
+    bool pawns = material.hasPawns();
+    squares[1] = int(index % 64);
+    index /= 64;
+    squares[0] = kingSquare(pawns, int(index % size_t(kingSlots(pawns))));
+    stm = int(index / size_t(kingSlots(pawns)));
+}
+
+int Tablebases::load(const std::string& directory) {
+    int loaded = 0;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (entry.path().extension() == ".tb" && add(entry.path().string())) {
+            ++loaded;
+        }
+    }
+    return loaded;
+}
+
+bool Tablebases::add(const std::string& path) {
+    auto table = std::make_unique<Table>();
+    if (!table->file.open(path, MappedFile::Access::RANDOM) || table->file.size() < sizeof(TbHeader)) {
+        return false;
+    }
+
+    TbHeader header;
+    memcpy(&header, table->file.data(), sizeof(header));
+    const char* end = static_cast<const char*>(memchr(header.material, 0, sizeof(header.material)));
+    std::string name(header.material, end ? size_t(end - header.material) : sizeof(header.material));
+    if (memcmp(header.magic, TB_MAGIC, sizeof(header.magic)) != 0
+        || header.version != TB_VERSION
+        || !TbMaterial::parse(name, table->material)
+        || !table->material.isCanonical()
+        || header.pieceCount != uint32_t(table->material.count)
+        || header.entryCount != table->material.entryCount()
+        || table->file.size() != sizeof(TbHeader) + header.entryCount) {
+        return false;
+    }
+
+    table->values = reinterpret_cast<const uint8_t*>(table->file.data() + sizeof(TbHeader));
+    if (table->material.count > largest) {
+        largest = table->material.count;
+    }
+    // Набор с одинаковыми фигурами у обеих сторон читается без отражения
+    links[table->material.flipped().key()] = { table.get(), true };
+    links[table->material.key()] = { table.get(), false };
+    tables.push_back(std::move(table));
+    return true;
+}
+
+void Tablebases::clear() {
+    links.clear();
+    tables.clear();
+    largest = 0;
+}
+
+bool Tablebases::contains(const TbMaterial& material) const {
+    return material.count == 2 || links.count(material.key()) != 0;
+}
+
+bool Tablebases::probeSquares(const TbMaterial& material, const int* squares, int stm, uint8_t& value) const {
+    if (material.count == 2) {
+        value = TB_DRAW;
+        return true;
+    }
+
+    auto it = links.find(material.key());
+    if (it == links.end()) {
+        return false;
+    }
+    const Table* table = it->second.table;
+    if (!it->second.flip) {
+        size_t index = tbIndex(table->material, stm, squares);
+        value = index == TB_NO_INDEX ? TB_INVALID : table->values[index];
+        return true;
+    }
+
+    // Обратная раскраска: доска отражается по горизонтали, цвета меняются местами
+    int mirrored[TB_MAX_PIECES];
+    mirrored[0] = squares[1] ^ 56;
+    mirrored[1] = squares[0] ^ 56;
+    int n = 2;
+    for (int side = 1; side >= 0; --side) {
+        for (int i = 2; i < material.count; ++i) {
+            if (material.color[i] == side) {
+                mirrored[n++] = squares[i] ^ 56;
+            }
+        }
+    }
+    size_t index = tbIndex(table->material, stm ^ 1, mirrored);
+    value = index == TB_NO_INDEX ? TB_INVALID : table->values[index];
+    return true;
+}
+
+bool Tablebases::probe(const ChessBoard& board, TbResult& result) const {
+    // В таблицах нет прав на рокировку и взятия на проходе: такие позиции не ищутся
+    TbMaterial material;
+    if (!largest || !TbMaterial::fromBoard(board, material)
+        || board.castlingRights() || board.enPassantTarget() >= 0) {
+        return false;
+    }
+
+    int squares[TB_MAX_PIECES];
+    boardSquares(board, squares);
+    uint8_t value;
+    int stm = board.sideToMove() == Color::WHITE ? 0 : 1;
+    if (!probeSquares(material, squares, stm, value) || value == TB_INVALID) {
+        return false;
+    }
+
+    if (value == TB_DRAW) {
+        result.wdl = 0;
+        result.plies = 0;
+    }
+    else {
+        result.plies = value - 1;
+        result.wdl = (result.plies % 2) ? 1 : -1;
+    }
+    return true;
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ChessBoard.h"
+#include "MappedFile.h"
+
+// Таблицы эндшпиля для малых наборов фигур (KNK, KNNK, KPK, KPPK...), построенные
+// ретроградным анализом по правилам игры (с превращениями и взятием на проходе;
+// позиции с правом рокировки или взятия на проходе в таблицы не входят).
+// Файл таблицы <набор>.tb:
+//   заголовок TbHeader
+//   по байту на позицию с точностью до симметрии доски (порядок - см. tbIndex).
+//   Значение байта: TB_DRAW - ничья, TB_INVALID - позиция невозможна, иначе
+//   число полуходов до мата + 1. Нечетное число полуходов - выигрыш стороны,
+//   которой ходить, четное - проигрыш
+// Таблица хранится только для "канонического" набора, где белые не слабее черных;
+// обратный набор читается из нее отражением доски и сменой цветов
+
+const int TB_MAX_PIECES = 4;
+
+const uint8_t TB_DRAW = 0;
+const uint8_t TB_INVALID = 255;
+const int TB_MAX_PLIES = 253;
+
+struct TbHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t pieceCount;
+    char material[8];         // Название набора ("KNNK"), дополненное нулями
+    uint64_t entryCount;
+};
+
+static_assert(sizeof(TbHeader) == 32, "TbHeader must stay 32 bytes");
+
+const char TB_MAGIC[8] = { 'C', 'H', 'S', 'T', 'B', '\0', '\0', '\0' };
+
+// Версия формата и правил: таблицы, построенные по другим правилам, не загружаются
+const uint32_t TB_VERSION = 3;
+
+// Набор фигур таблицы: белый король, черный король, затем остальные фигуры
+// белых и черных в порядке PieceType
+struct TbMaterial {
+    int count = 0;
+    PieceType type[TB_MAX_PIECES] = {};
+    int color[TB_MAX_PIECES] = {};    // 0 - белые, 1 - черные
+
+    // Разбор названия вида "KNNK", "KPKP" (фигуры белых, затем черных, каждые с короля)
+    static bool parse(const std::string& name, TbMaterial& out);
+
+    // Набор фигур на доске (false, если фигур больше TB_MAX_PIECES)
+    static bool fromBoard(const ChessBoard& board, TbMaterial& out);
+
+    std::string name() const;
+
+    // Ключ набора: число фигур каждого типа и цвета
+    uint32_t key() const;
+
+    // Белые не слабее черных: такой набор хранится в файле
+    bool isCanonical() const;
+
+    // Тот же набор со сменой цветов
+    TbMaterial flipped() const;
+
+    // Есть ли в наборе пешки (без них доска симметрична и по горизонтали, и по диагонали)
+    bool hasPawns() const;
+
+    // Число записей в файле таблицы
+    size_t entryCount() const;
+};
+
+const size_t TB_NO_INDEX = ~size_t(0);
+
+// Номер записи файла таблицы по очереди хода (0 - белые) и клеткам фигур набора.
+// Позиция приводится симметрией доски: белый король - на вертикалях a-d, а в
+// наборах без пешек - в треугольнике a1-d1-d4. Одинаковые фигуры одной стороны
+// записываются парой клеток без учета порядка, пешки - только на горизонталях 2-7.
+// TB_NO_INDEX - таких записей нет (пешка на крайней горизонтали, две одинаковые
+// фигуры на одной клетке)
+size_t tbIndex(const TbMaterial& material, int stm, const int* squares);
+
+// Очередь хода и клетки фигур позиции, записанной под номером index (обратно tbIndex)
+void tbPosition(const TbMaterial& material, size_t index, int& stm, int* squares);
+
+// Результат с точки зрения стороны, которой ходить: 1 - выигрыш, 0 - ничья,
+// -1 - проигрыш; plies - число полуходов до мата
+struct TbResult {
+    int wdl = 0;
+    int plies = 0;
+};
+
+// Загруженные таблицы. Файлы отображаются в память и читаются без копирования;
+// после загрузки класс только читает данные, поэтому probe можно вызывать из
+// любого числа потоков
+class Tablebases {
+private:
+    struct Table {
+        TbMaterial material;
+        MappedFile file;
+        const uint8_t* values = nullptr;
+    };
+
+    // Таблица для ключа набора; flip - набор читается с обратной раскраской
+    struct Link {
+        const Table* table;
+        bool flip;
+    };
+
+    std::vector<std::unique_ptr<Table>> tables;
+    std::unordered_map<uint32_t, Link> links;
+    int largest = 0;
+
+public:
+    // Загрузка всех таблиц *.tb из каталога; возвращает число загруженных
+    int load(const std::string& directory);
+
+    // Загрузка одного файла таблицы
+    bool add(const std::string& path);
+
+    void clear();
+
+    size_t tableCount() const {
+        return tables.size();
+    }
+
+    // Наибольшее число фигур в загруженных таблицах (0 - таблиц нет)
+    int maxPieces() const {
+        return largest;
+    }
+
+    // Есть ли таблица для набора (в любой раскраске)
+    bool contains(const TbMaterial& material) const;
+
+    // Значение байта таблицы для позиции набора material (в любой раскраске);
+    // только короли - всегда ничья. false - таблицы нет
+    bool probeSquares(const TbMaterial& material, const int* squares, int stm, uint8_t& value) const;
+
+    // Результат для позиции на доске; false - позиции нет в таблицах (в том числе
+    // при праве на рокировку или взятие на проходе). Правило 50 ходов не учитывается
+    bool probe(const ChessBoard& board, TbResult& result) const;
+};
+
+// Сводка построения таблицы
+struct TbGenInfo {
+    uint64_t legal = 0;       // Возможные позиции
+    uint64_t wins = 0;        // Выигрыш стороны, которой ходить
+    uint64_t losses = 0;
+    int longestMate = 0;      // Самый длинный мат, полуходы
+    int passes = 0;           // Проходы ретроградного анализа
+};
+
+// Наборы фигур, в которые переходит material при взятиях и превращениях
+// (канонические, без набора из одних королей)
+std::vector<TbMaterial> tbDependencies(const TbMaterial& material);
+
+// Построение таблицы канонического набора material ретроградным анализом в
+// threads потоков и запись в каталог directory. Таблицы наборов, в которые
+// ведут взятия и превращения, должны быть загружены в tables; готовая таблица тоже
+// загружается в tables
+bool generateTablebase(const TbMaterial& material, const std::string& directory, int threads,
+                       Tablebases& tables, TbGenInfo& info);
@@ -0,0 +1,745 @@
+// Построение таблиц эндшпиля ретроградным анализом.
+//
+// 1. Начальный проход: для каждой позиции - ходы по правилам программы. Мат -
+//    проигрыш в 0 полуходов, пат - ничья. Взятия и превращения ("выходы") ведут
+//    в готовые таблицы других наборов; если все ходы - выходы, значение позиции
+//    известно сразу, иначе запоминается самый быстрый выигрыш выходом (или, если
+//    все выходы проигрывают, самый долгий проигрыш).
+// 2. Проход p (p = 1, 2...) находит позиции с матом ровно в p полуходов:
+//    при нечетном p - предшественники проигрышей в p - 1 (обратные ходы из них)
+//    и выигрыши выходом в p; при четном p - предшественники выигрышей в p - 1
+//    и позиции с самым долгим проигрышем выходом в p, у которых все ходы ведут
+//    к выигрышу соперника не дольше чем в p - 1.
+// Двойной ход пешки, после которого ее может взять на проходе пешка соперника,
+// ведет в позицию, которой нет в таблице (в ней есть право взятия). Такие ходы не
+// перебираются обратно; позиции, из которых они возможны, на каждом проходе
+// проверяются прямым перебором ходов.
+// Позиции, не получившие значения, - ничьи. Каждый проход делится между
+// потоками по диапазонам индексов; значения - атомарные байты, поэтому потоки
+// могут одновременно записывать одну и ту же позицию (значение будет одинаковым)
+
+#include "Tablebase.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// Позиция генератора: клетки фигур набора (-1 - фигура взята) и очередь хода
+struct GenPosition {
+    int sq[TB_MAX_PIECES];
+    int stm;
+};
+
+// Ход генератора: номер взятой фигуры, фигура превращения и поле взятия на проходе,
+// если после двойного хода пешки рядом с ней стоит пешка соперника
+struct GenMove {
+    int mover = -1;
+    int captured = -1;
+    PieceType promotion = PieceType::NONE;
+    int epSquare = -1;
+
+    // Ход ведет в таблицу другого набора
+    bool exits() const {
+        return captured >= 0 || promotion != PieceType::NONE;
+    }
+};
+
+const PieceType PromotionPieces[] = { PieceType::QUEEN, PieceType::ROOK, PieceType::BISHOP, PieceType::KNIGHT };
+
+// Набор из n фигур (короли - первыми двумя) в порядке TbMaterial; order[k] -
+// исходный номер k-й фигуры набора
+TbMaterial sortedMaterial(const PieceType* type, const int* color, int n, int* order) {
+    TbMaterial m;
+    m.count = n;
+    for (int i = 0; i < n; ++i) {
+        order[i] = i;
+    }
+    auto rank = [&](int i) {
+        return i < 2 ? i : 2 + color[i] * 8 + int(type[i]);
+    };
+    std::stable_sort(order, order + n, [&](int a, int b) {
+        return rank(a) < rank(b);
+    });
+    for (int i = 0; i < n; ++i) {
+        m.type[i] = type[order[i]];
+        m.color[i] = color[order[i]];
+    }
+    return m;
+}
+
+Bitboard pieceAttacks(PieceType type, int color, int sq, Bitboard occupied) {
+    switch (type) {
+    case PieceType::KING: return KingAttacks.sq[sq];
+    case PieceType::QUEEN: return queenAttacks(sq, occupied);
+    case PieceType::ROOK: return rookAttacks(sq, occupied);
+    case PieceType::BISHOP: return bishopAttacks(sq, occupied);
+    case PieceType::KNIGHT: return KnightAttacks.sq[sq];
+    default: return PawnAttacks.sq[color][sq];
+    }
+}
+
+// Выполнение func(begin, end) над диапазонами индексов в threads потоках;
+// возвращает наибольший из результатов
+template <typename Func>
+uint64_t parallelFor(size_t size, int threads, Func func) {
+    const size_t CHUNK = size_t(1) << 16;
+    std::atomic<size_t> next{ 0 };
+    std::mutex mutex;
+    uint64_t best = 0;
+    auto worker = [&]() {
+        uint64_t local = 0;
+        for (;;) {
+            size_t begin = next.fetch_add(CHUNK);
+            if (begin >= size) {
+                break;
+            }
+            local = std::max(local, func(begin, std::min(size, begin + CHUNK)));
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        best = std::max(best, local);
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : pool) {
+        t.join();
+    }
+    return best;
+}
+
+class Generator {
+private:
+    const TbMaterial& material;
+    const Tablebases& tables;
+    int count;
+    size_t size;
+    std::unique_ptr<std::atomic<uint8_t>[]> values;
+    std::vector<uint8_t> exitResult;       // Итог по лучшему выходу: полуходы + 1 (0 - нет)
+    TbMaterial reduced[TB_MAX_PIECES];     // Набор после взятия фигуры i
+    std::vector<size_t> exposedParents;    // Позиции с двойным ходом пешки под взятие на проходе
+    std::mutex exposedMutex;
+
+    bool decode(size_t index, GenPosition& p) const {
+        p.stm = int(index >> (6 * count));
+        Bitboard occupied = 0;
+        for (int i = count - 1; i >= 0; --i) {
+            p.sq[i] = int(index & 63);
+            index >>= 6;
+            occupied |= squareBB(p.sq[i]);
+        }
+        return popCount(occupied) == count;
+    }
+
+    // Номер позиции в рабочем массиве: [очередь хода][клетки фигур], 64 варианта
+    // клетки на фигуру (в файл попадает только часть позиций, см. write)
+    size_t encode(const GenPosition& p) const {
+        size_t index = size_t(p.stm);
+        for (int i = 0; i < count; ++i) {
+            index = (index << 6) | size_t(p.sq[i]);
+        }
+        return index;
+    }
+
+    Bitboard occupancy(const GenPosition& p, int color) const {
+        Bitboard b = 0;
+        for (int i = 0; i < count; ++i) {
+            if (p.sq[i] >= 0 && material.color[i] == color) {
+                b |= squareBB(p.sq[i]);
+            }
+        }
+        return b;
+    }
+
+    // Атакована ли клетка sq фигурами цвета by
+    bool attacked(const GenPosition& p, int sq, int by, Bitboard occupied) const {
+        for (int i = 0; i < count; ++i) {
+            if (p.sq[i] >= 0 && material.color[i] == by
+                && (pieceAttacks(material.type[i], by, p.sq[i], occupied) & squareBB(sq))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Возможная позиция: пешки не на крайних горизонталях, сторона, которая
+    // не ходит, не под шахом (в том числе короли не стоят рядом)
+    bool valid(const GenPosition& p) const {
+        for (int i = 2; i < count; ++i) {
+            if (material.type[i] == PieceType::PAWN && (rankOf(p.sq[i]) == 0 || rankOf(p.sq[i]) == 7)) {
+                return false;
+            }
+        }
+        Bitboard occupied = occupancy(p, 0) | occupancy(p, 1);
+        return !attacked(p, p.sq[p.stm ^ 1], p.stm, occupied);
+    }
+
+    Bitboard pawnsOf(const GenPosition& p, int color) const {
+        Bitboard b = 0;
+        for (int i = 2; i < count; ++i) {
+            if (p.sq[i] >= 0 && material.color[i] == color && material.type[i] == PieceType::PAWN) {
+                b |= squareBB(p.sq[i]);
+            }
+        }
+        return b;
+    }
+
+    // Пешки соперника на соседних с клеткой sq вертикалях той же горизонтали
+    static Bitboard besideSquare(int sq) {
+        return ((squareBB(sq) & ~FILE_A_BB) >> 1) | ((squareBB(sq) & ~FILE_H_BB) << 1);
+    }
+
+    // Допустимые ходы: visit(позиция после хода, ход); превращение - по ходу
+    // на каждую фигуру
+    template <typename Visit>
+    void forEachMove(const GenPosition& p, Visit visit) const {
+        int us = p.stm;
+        Bitboard own = occupancy(p, us);
+        Bitboard enemy = occupancy(p, us ^ 1);
+        Bitboard occupied = own | enemy;
+        Bitboard enemyPawns = pawnsOf(p, us ^ 1);
+
+        for (int i = 0; i < count; ++i) {
+            if (material.color[i] != us) {
+                continue;
+            }
+            int from = p.sq[i];
+            Bitboard targets;
+            bool pawn = material.type[i] == PieceType::PAWN;
+            if (pawn) {
+                targets = PawnAttacks.sq[us][from] & enemy;
+                int step = (us == 0) ? 8 : -8;
+                if (!(occupied & squareBB(from + step))) {
+                    targets |= squareBB(from + step);
+                    if (rankOf(from) == (us == 0 ? 1 : 6) && !(occupied & squareBB(from + 2 * step))) {
+                        targets |= squareBB(from + 2 * step);
+                    }
+                }
+            }
+            else {
+                targets = pieceAttacks(material.type[i], us, from, occupied) & ~own;
+            }
+
+            while (targets) {
+                int to = popLsb(targets);
+                GenPosition child = p;
+                child.sq[i] = to;
+                child.stm = us ^ 1;
+                GenMove move;
+                move.mover = i;
+                if (enemy & squareBB(to)) {
+                    for (int j = 0; j < count; ++j) {
+                        if (p.sq[j] == to) {
+                            move.captured = j;
+                            child.sq[j] = -1;
+                        }
+                    }
+                }
+                Bitboard after = (occupied ^ squareBB(from)) | squareBB(to);
+                if (attacked(child, child.sq[us], us ^ 1, after)) {
+                    continue;
+                }
+                if (pawn && (rankOf(to) == 0 || rankOf(to) == 7)) {
+                    for (PieceType promotion : PromotionPieces) {
+                        move.promotion = promotion;
+                        if (!visit(child, move)) {
+                            return;
+                        }
+                    }
+                    continue;
+                }
+                if (pawn && (to - from == 16 || from - to == 16) && (besideSquare(to) & enemyPawns)) {
+                    move.epSquare = (from + to) / 2;
+                }
+                if (!visit(child, move)) {
+                    return;
+                }
+            }
+        }
+    }
+
+    // Обратные ходы стороны, сделавшей последний ход, без взятий и превращений:
+    // visit(индекс предшествующей позиции). Двойной ход пешки, открывающий взятие
+    // на проходе, ведет не в эту позицию и пропускается
+    template <typename Visit>
+    void forEachUnmove(const GenPosition& p, Visit visit) const {
+        int them = p.stm ^ 1;
+        Bitboard occupied = occupancy(p, 0) | occupancy(p, 1);
+        Bitboard enemyPawns = pawnsOf(p, p.stm);
+
+        for (int i = 0; i < count; ++i) {
+            if (material.color[i] != them) {
+                continue;
+            }
+            int to = p.sq[i];
+            Bitboard sources;
+            if (material.type[i] == PieceType::PAWN) {
+                int step = (them == 0) ? -8 : 8;
+                int relative = (them == 0) ? rankOf(to) : 7 - rankOf(to);
+                sources = 0;
+                if (relative >= 2 && !(occupied & squareBB(to + step))) {
+                    sources |= squareBB(to + step);
+                    if (relative == 3 && !(occupied & squareBB(to + 2 * step))
+                        && !(besideSquare(to) & enemyPawns)) {
+                        sources |= squareBB(to + 2 * step);
+                    }
+                }
+            }
+            else {
+                // Ходы короля, коня и дальнобойных фигур обратимы
+                sources = pieceAttacks(material.type[i], them, to, occupied) & ~occupied;
+            }
+
+            while (sources) {
+                GenPosition prev = p;
+                prev.sq[i] = popLsb(sources);
+                prev.stm = them;
+                visit(encode(prev));
+            }
+        }
+    }
+
+    // Значение позиции после выхода из таблицы другого набора
+    uint8_t exitValue(const GenPosition& child, const GenMove& move) const {
+        int squares[TB_MAX_PIECES];
+        uint8_t value = TB_DRAW;
+        if (move.promotion == PieceType::NONE) {
+            // Простое взятие: набор без взятой фигуры известен заранее
+            int n = 0;
+            for (int i = 0; i < count; ++i) {
+                if (i != move.captured) {
+                    squares[n++] = child.sq[i];
+                }
+            }
+            tables.probeSquares(reduced[move.captured], squares, child.stm, value);
+        }
+        else {
+            PieceType type[TB_MAX_PIECES];
+            int color[TB_MAX_PIECES];
+            int sq[TB_MAX_PIECES];
+            int n = 0;
+            for (int i = 0; i < count; ++i) {
+                if (i != move.captured) {
+                    type[n] = (i == move.mover) ? move.promotion : material.type[i];
+                    color[n] = material.color[i];
+                    sq[n] = child.sq[i];
+                    ++n;
+                }
+            }
+            int order[TB_MAX_PIECES];
+            TbMaterial m = sortedMaterial(type, color, n, order);
+            for (int i = 0; i < n; ++i) {
+                squares[i] = sq[order[i]];
+            }
+            tables.probeSquares(m, squares, child.stm, value);
+        }
+        return value == TB_INVALID ? TB_DRAW : value;
+    }
+
+    // Лучшее для стороны, которой ходить, из двух значений ходов
+    static uint8_t better(uint8_t a, uint8_t b) {
+        auto score = [](uint8_t v) {
+            return v == TB_DRAW ? 0 : (v - 1) % 2 ? 1000 - v : v - 1000;
+        };
+        return score(a) >= score(b) ? a : b;
+    }
+
+    // Значение позиции после двойного хода пешки с правом взятия на проходе:
+    // лучшее из значения таблицы (остальные ходы) и взятий на проходе
+    uint8_t withEnPassant(const GenPosition& child, int epSquare, uint8_t value) const {
+        int us = child.stm;
+        int captured = -1;
+        for (int j = 2; j < count; ++j) {
+            if (child.sq[j] == (epSquare ^ 8)) {
+                captured = j;
+            }
+        }
+
+        bool any = false;
+        uint8_t best = TB_DRAW;
+        for (int i = 2; i < count; ++i) {
+            if (material.color[i] != us || material.type[i] != PieceType::PAWN || child.sq[i] < 0
+                || !(PawnAttacks.sq[us][child.sq[i]] & squareBB(epSquare))) {
+                continue;
+            }
+            GenPosition next = child;
+            next.sq[i] = epSquare;
+            next.sq[captured] = -1;
+            next.stm = us ^ 1;
+            Bitboard occupied = occupancy(next, 0) | occupancy(next, 1);
+            if (attacked(next, next.sq[us], us ^ 1, occupied)) {
+                continue;
+            }
+            GenMove move;
+            move.mover = i;
+            move.captured = captured;
+            // Значение для взявшего: на полуход дальше и с обратным знаком
+            uint8_t taken = exitValue(next, move);
+            taken = taken == TB_DRAW ? TB_DRAW : uint8_t(taken + 1);
+            best = any ? better(best, taken) : taken;
+            any = true;
+        }
+        if (!any) {
+            return value;
+        }
+
+        // Без других ходов значение таблицы - мат или пат, а не исход хода
+        bool moves = false;
+        forEachMove(child, [&](const GenPosition&, const GenMove&) {
+            moves = true;
+            return false;
+        });
+        return moves ? better(value, best) : best;
+    }
+
+    // Значение позиции после хода (для стороны, которой в ней ходить)
+    uint8_t childValue(const GenPosition& child, const GenMove& move) const {
+        if (move.exits()) {
+            return exitValue(child, move);
+        }
+        uint8_t value = values[encode(child)].load(std::memory_order_relaxed);
+        return move.epSquare < 0 ? value : withEnPassant(child, move.epSquare, value);
+    }
+
+    // Начальный проход по диапазону; возвращает наибольшее число полуходов
+    // среди найденных в нем значений
+    uint64_t initialize(size_t begin, size_t end) {
+        uint64_t longest = 0;
+        for (size_t index = begin; index < end; ++index) {
+            GenPosition p;
+            if (!decode(index, p) || !valid(p)) {
+                values[index].store(TB_INVALID, std::memory_order_relaxed);
+                continue;
+            }
+
+            int moves = 0;
+            int quiet = 0;
+            int bestWin = INT_MAX;    // Самый быстрый выигрыш выходом
+            int worstLoss = -1;       // Самый долгий проигрыш выходом
+            bool drawn = false;
+            bool exposed = false;     // Есть двойной ход пешки под взятие на проходе
+            forEachMove(p, [&](const GenPosition& child, const GenMove& move) {
+                ++moves;
+                if (!move.exits()) {
+                    ++quiet;
+                    exposed = exposed || move.epSquare >= 0;
+                    return true;
+                }
+                uint8_t value = exitValue(child, move);
+                if (value == TB_DRAW) {
+                    drawn = true;
+                }
+                else if ((value - 1) % 2 == 0) {
+                    bestWin = std::min(bestWin, int(value));
+                }
+                else {
+                    worstLoss = std::max(worstLoss, int(value));
+                }
+                return true;
+            });
+
+            uint8_t value = TB_DRAW;
+            if (moves == 0) {
+                Bitboard occupied = occupancy(p, 0) | occupancy(p, 1);
+                value = attacked(p, p.sq[p.stm], p.stm ^ 1, occupied) ? 1 : TB_DRAW;
+            }
+            else if (quiet == 0) {
+                // Все ходы - выходы: значение следует из таблиц других наборов
+                value = (bestWin != INT_MAX) ? uint8_t(bestWin + 1)
+                      : drawn ? TB_DRAW
+                      : uint8_t(worstLoss + 1);
+            }
+            else if (bestWin != INT_MAX) {
+                exitResult[index] = uint8_t(bestWin + 1);
+                longest = std::max<uint64_t>(longest, uint64_t(bestWin));
+            }
+            else if (!drawn && worstLoss >= 0) {
+                // Проигрыш не раньше самого долгого выхода: проверяется на его проходе,
+                // даже если к позиции не ведет ни один обратный ход
+                exitResult[index] = uint8_t(worstLoss + 1);
+                longest = std::max<uint64_t>(longest, uint64_t(worstLoss));
+            }
+            values[index].store(value, std::memory_order_relaxed);
+            if (value != TB_DRAW) {
+                longest = std::max<uint64_t>(longest, uint64_t(value - 1));
+            }
+            else if (exposed) {
+                std::lock_guard<std::mutex> lock(exposedMutex);
+                exposedParents.push_back(index);
+            }
+        }
+        return longest;
+    }
+
+    // Все ходы позиции ведут к выигрышу соперника не дольше чем в plies полуходов
+    bool allMovesLose(const GenPosition& p, int plies) const {
+        bool lost = true;
+        forEachMove(p, [&](const GenPosition& child, const GenMove& move) {
+            uint8_t value = childValue(child, move);
+            if (value == TB_DRAW || value == TB_INVALID || value - 1 > plies || (value - 1) % 2 == 0) {
+                lost = false;
+            }
+            return lost;
+        });
+        return lost;
+    }
+
+    // Проход, находящий позиции с матом ровно в plies полуходов; возвращает их число
+    // в диапазоне
+    uint64_t pass(size_t begin, size_t end, int plies) {
+        uint64_t found = 0;
+        uint8_t frontier = uint8_t(plies);     // Значение позиций с матом в plies - 1
+        uint8_t result = uint8_t(plies + 1);
+        auto mark = [&](size_t index) {
+            uint8_t expected = TB_DRAW;
+            if (values[index].compare_exchange_strong(expected, result, std::memory_order_relaxed)) {
+                ++found;
+            }
+        };
+
+        for (size_t index = begin; index < end; ++index) {
+            uint8_t value = values[index].load(std::memory_order_relaxed);
+            if (plies % 2 == 1) {
+                if (value == TB_DRAW && exitResult[index] == result) {
+                    mark(index);
+                }
+                if (value != frontier) {
+                    continue;
+                }
+                // Проигрыш соперника: каждый предшественник выигрывает
+                GenPosition p;
+                decode(index, p);
+                forEachUnmove(p, [&](size_t prev) {
+                    if (values[prev].load(std::memory_order_relaxed) == TB_DRAW) {
+                        mark(prev);
+                    }
+                });
+            }
+            else {
+                if (value == TB_DRAW && exitResult[index] == result) {
+                    GenPosition p;
+                    decode(index, p);
+                    if (allMovesLose(p, plies - 1)) {
+                        mark(index);
+                    }
+                }
+                if (value != frontier) {
+                    continue;
+                }
+                // Выигрыш соперника: предшественник проигрывает, если так ведут все его ходы
+                GenPosition p;
+                decode(index, p);
+                forEachUnmove(p, [&](size_t prev) {
+                    if (values[prev].load(std::memory_order_relaxed) != TB_DRAW) {
+                        return;
+                    }
+                    GenPosition q;
+                    decode(prev, q);
+                    if (allMovesLose(q, plies - 1)) {
+                        mark(prev);
+                    }
+                });
+            }
+        }
+        return found;
+    }
+
+    // Прямая проверка позиций с двойным ходом пешки под взятие на проходе: к ним
+    // не ведут обратные ходы из позиций после такого хода
+    uint64_t passExposed(size_t begin, size_t end, int plies) {
+        uint64_t found = 0;
+        uint8_t result = uint8_t(plies + 1);
+        for (size_t k = begin; k < end; ++k) {
+            size_t index = exposedParents[k];
+            if (values[index].load(std::memory_order_relaxed) != TB_DRAW) {
+                continue;
+            }
+            GenPosition p;
+            decode(index, p);
+            bool decided = false;
+            if (plies % 2 == 1) {
+                forEachMove(p, [&](const GenPosition& child, const GenMove& move) {
+                    decided = move.epSquare >= 0 && childValue(child, move) == uint8_t(plies);
+                    return !decided;
+                });
+            }
+            else {
+                decided = allMovesLose(p, plies - 1);
+            }
+            uint8_t expected = TB_DRAW;
+            if (decided && values[index].compare_exchange_strong(expected, result, std::memory_order_relaxed)) {
+                ++found;
+            }
+        }
+        return found;
+    }
+
+public:
+    Generator(const TbMaterial& m, const Tablebases& t)
+        : material(m), tables(t), count(m.count), size(size_t(2) << (6 * m.count)),
+          values(new std::atomic<uint8_t>[size]), exitResult(size, 0) {
+        for (int j = 2; j < count; ++j) {
+            TbMaterial& r = reduced[j];
+            r.count = 0;
+            for (int i = 0; i < count; ++i) {
+                if (i != j) {
+                    r.type[r.count] = material.type[i];
+                    r.color[r.count] = material.color[i];
+                    ++r.count;
+                }
+            }
+        }
+    }
+
+    void run(int threads, TbGenInfo& info) {
+        // Самый долгий мат, известный после начального прохода: до него проходы
+        // продолжаются, даже если очередной ничего не нашел
+        int longest = int(parallelFor(size, threads, [&](size_t begin, size_t end) {
+            return initialize(begin, end);
+        }));
+
+        int plies = 1;
+        int lastFound = 0;
+        for (; plies <= TB_MAX_PLIES && plies <= std::max(longest, lastFound) + 1; ++plies) {
+            uint64_t found = parallelFor(size, threads, [&](size_t begin, size_t end) {
+                return pass(begin, end, plies);
+            });
+            found += parallelFor(exposedParents.size(), threads, [&](size_t begin, size_t end) {
+                return passExposed(begin, end, plies);
+            });
+            if (found) {
+                lastFound = plies;
+            }
+        }
+        info.passes = plies - 1;
+
+        info.legal = info.wins = info.losses = 0;
+        info.longestMate = 0;
+        for (size_t i = 0; i < size; ++i) {
+            uint8_t value = values[i].load(std::memory_order_relaxed);
+            if (value == TB_INVALID) {
+                continue;
+            }
+            ++info.legal;
+            if (value != TB_DRAW) {
+                ((value - 1) % 2 ? info.wins : info.losses)++;
+                info.longestMate = std::max(info.longestMate, int(value - 1));
+            }
+        }
+    }
+
+    bool write(const std::string& path) const {
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+
+        TbHeader header = {};
+        memcpy(header.magic, TB_MAGIC, sizeof(header.magic));
+        header.version = TB_VERSION;
+        header.pieceCount = uint32_t(count);
+        std::string name = material.name();
+        memcpy(header.material, name.data(), name.size());
+        size_t entries = material.entryCount();
+        header.entryCount = entries;
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+        // Перебор считается по всем расстановкам, а записывается по одной позиции
+        // из каждой группы симметричных (порядок записей - tbIndex)
+        std::vector<uint8_t> buffer(size_t(1) << 20);
+        for (size_t begin = 0; ok && begin < entries; begin += buffer.size()) {
+            size_t n = std::min(buffer.size(), entries - begin);
+            for (size_t i = 0; i < n; ++i) {
+                GenPosition p;
+                tbPosition(material, begin + i, p.stm, p.sq);
+                buffer[i] = values[encode(p)].load(std::memory_order_relaxed);
+            }
+            ok = fwrite(buffer.data(), 1, n, file) == n;
+        }
+        return fclose(file) == 0 && ok;
+    }
+};
+
+} // namespace
+
+std::vector<TbMaterial> tbDependencies(const TbMaterial& material) {
+    std::vector<TbMaterial> result;
+    // captured - взятая фигура, promoted - превращающаяся пешка (-1 - нет)
+    for (int captured = -1; captured < material.count; ++captured) {
+        for (int promoted = -1; promoted < material.count; ++promoted) {
+            if ((captured >= 0 && captured < 2) || (captured < 0 && promoted < 0)) {
+                continue;
+            }
+            if (promoted >= 0 && (material.type[promoted] != PieceType::PAWN || promoted == captured)) {
+                continue;
+            }
+            // Превращение со взятием: пешка бьет фигуру соперника на последней горизонтали
+            if (promoted >= 0 && captured >= 0
+                && (material.color[captured] == material.color[promoted]
+                    || material.type[captured] == PieceType::PAWN)) {
+                continue;
+            }
+
+            for (PieceType promotion : PromotionPieces) {
+                PieceType type[TB_MAX_PIECES];
+                int color[TB_MAX_PIECES];
+                int n = 0;
+                for (int i = 0; i < material.count; ++i) {
+                    if (i != captured) {
+                        type[n] = (i == promoted) ? promotion : material.type[i];
+                        color[n] = material.color[i];
+                        ++n;
+                    }
+                }
+                int order[TB_MAX_PIECES];
+                TbMaterial r = sortedMaterial(type, color, n, order);
+                if (r.count > 2) {
+                    if (!r.isCanonical()) {
+                        r = r.flipped();
+                    }
+                    bool known = false;
+                    for (const TbMaterial& m : result) {
+                        known = known || m.key() == r.key();
+                    }
+                    if (!known) {
+                        result.push_back(r);
+                    }
+                }
+                if (promoted < 0) {
+                    break;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+bool generateTablebase(const TbMaterial& material, const std::string& directory, int threads,
+                       Tablebases& tables, TbGenInfo& info) {
+    if (material.count < 3 || material.count > TB_MAX_PIECES || !material.isCanonical()) {
+        return false;
+    }
+    for (const TbMaterial& dependency : tbDependencies(material)) {
+        if (!tables.contains(dependency)) {
+            return false;
+        }
+    }
+
+    std::string path = directory + "/" + material.name() + ".tb";
+    {
+        Generator generator(material, tables);
+        generator.run(std::max(1, threads), info);
+        if (!generator.write(path)) {
+            return false;
+        }
+    }
+    return tables.add(path);
+}
@@ -0,0 +1,278 @@
+// Построение таблиц эндшпиля (см. Tablebase.h).
+//
+//   tbgen [-t N] [-d каталог] [-f] [--verify N] [набор...]
+//
+// Без наборов строятся таблицы для уровней 1 и 2: KNK, KNNK, KNKN, KPK, KPKP, KPPK.
+// Таблицы, в которые ведут взятия и превращения, строятся первыми; уже готовые файлы
+// загружаются, а не строятся заново (-f - построить все заново). --verify N
+// сверяет N случайных позиций каждой таблицы с генератором ходов доски: значение
+// позиции должно следовать из значений позиций после каждого допустимого хода
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ChessBoard.h"
+#include "Tablebase.h"
+
+using namespace std;
+
+namespace {
+
+const char* DefaultTables[] = { "KNK", "KNNK", "KNKN", "KPK", "KPKP", "KPPK" };
+
+struct Options {
+    int threads = max(1, int(thread::hardware_concurrency()));
+    string directory = "tb";
+    bool force = false;
+    int verify = 0;
+};
+
+void usage() {
+    cout << "Использование:\n"
+         << "  tbgen [-t N] [-d каталог] [-f] [--verify N] [набор...]\n"
+         << "Наборы по умолчанию:";
+    for (const char* name : DefaultTables) {
+        cout << " " << name;
+    }
+    cout << "\n";
+}
+
+// FEN позиции таблицы по клеткам фигур набора
+string tableFen(const TbMaterial& material, const int* squares, int stm) {
+    static const char letters[] = "kqrbnp";
+    char grid[64];
+    memset(grid, 0, sizeof(grid));
+    for (int i = 0; i < material.count; ++i) {
+        char c = letters[int(material.type[i])];
+        grid[squares[i]] = material.color[i] == 0 ? char(toupper(c)) : c;
+    }
+
+    string fen;
+    for (int y = 7; y >= 0; --y) {
+        int empty = 0;
+        for (int x = 0; x < 8; ++x) {
+            char c = grid[makeSquare(x, y)];
+            if (!c) {
+                ++empty;
+                continue;
+            }
+            if (empty) {
+                fen += char('0' + empty);
+                empty = 0;
+            }
+            fen += c;
+        }
+        if (empty) {
+            fen += char('0' + empty);
+        }
+        if (y > 0) {
+            fen += '/';
+        }
+    }
+    fen += stm == 0 ? " w - - 0 1" : " b - - 0 1";
+    return fen;
+}
+
+bool resolve(ChessBoard& board, const Tablebases& tables, TbResult& result);
+
+// Значение позиции по ходам: мат, пат или лучший исход среди позиций после хода;
+// false - для какой-то позиции после хода значения нет
+bool evaluateMoves(ChessBoard& board, const Tablebases& tables, TbResult& result) {
+    MoveList list;
+    board.generateMoves(list);
+    if (list.empty()) {
+        result.wdl = board.isInCheck(board.sideToMove()) ? -1 : 0;
+        result.plies = 0;
+        return true;
+    }
+
+    result.wdl = -2;
+    for (Move move : list) {
+        board.makeMove(move);
+        TbResult child;
+        bool found = resolve(board, tables, child);
+        board.unmakeMove();
+        if (!found) {
+            return false;
+        }
+        int wdl = -child.wdl;
+        int plies = child.plies + 1;
+        // Выигрыш - быстрейший, проигрыш - самый долгий
+        bool better = wdl > result.wdl
+            || (wdl == result.wdl && wdl > 0 && plies < result.plies)
+            || (wdl == result.wdl && wdl < 0 && plies > result.plies);
+        if (better) {
+            result.wdl = wdl;
+            result.plies = wdl ? plies : 0;
+        }
+    }
+    return true;
+}
+
+// Значение позиции по таблицам. Позиции с правом взятия на проходе в таблицах
+// нет: она оценивается по ходам
+bool resolve(ChessBoard& board, const Tablebases& tables, TbResult& result) {
+    if (tables.probe(board, result)) {
+        return true;
+    }
+    if (popCount(board.occupied()) == 2) {
+        result = TbResult();    // Только короли
+        return true;
+    }
+    return board.enPassantTarget() >= 0 && evaluateMoves(board, tables, result);
+}
+
+// Сверка случайных позиций таблицы с генератором ходов доски; число расхождений
+int verifyTable(const TbMaterial& material, const Tablebases& tables, int samples) {
+    mt19937_64 random(material.key());
+    int checked = 0;
+    int errors = 0;
+    ChessBoard board;
+
+    for (int attempt = 0; checked < samples && attempt < samples * 100; ++attempt) {
+        int squares[TB_MAX_PIECES];
+        for (int i = 0; i < material.count; ++i) {
+            squares[i] = int(random() % 64);
+        }
+        int stm = int(random() % 2);
+        uint8_t value;
+        if (!tables.probeSquares(material, squares, stm, value) || value == TB_INVALID) {
+            continue;
+        }
+        string fen = tableFen(material, squares, stm);
+        if (!board.loadFen(fen)) {
+            continue;
+        }
+        ++checked;
+
+        TbResult result;
+        TbResult expected;
+        if (!tables.probe(board, result) || !evaluateMoves(board, tables, expected)) {
+            cerr << "  нет значения: " << fen << "\n";
+            ++errors;
+            continue;
+        }
+
+        if (expected.wdl != result.wdl || expected.plies != result.plies) {
+            cerr << "  расхождение: " << fen << " таблица " << result.wdl << "/" << result.plies
+                 << ", по ходам " << expected.wdl << "/" << expected.plies << "\n";
+            ++errors;
+        }
+    }
+    cout << "  проверено " << checked << " позиций, расхождений: " << errors << "\n";
+    return errors;
+}
+
+// Построение таблицы и (заранее) всех таблиц, в которые ведут взятия и превращения
+bool buildTable(const TbMaterial& material, const Options& options, Tablebases& tables, vector<uint32_t>& done) {
+    for (uint32_t key : done) {
+        if (key == material.key()) {
+            return true;
+        }
+    }
+    for (const TbMaterial& dependency : tbDependencies(material)) {
+        if (!buildTable(dependency, options, tables, done)) {
+            return false;
+        }
+    }
+
+    string path = options.directory + "/" + material.name() + ".tb";
+    if (!options.force && tables.add(path)) {
+        cout << material.name() << ": загружена " << path << "\n";
+        done.push_back(material.key());
+        return true;
+    }
+
+    auto start = chrono::steady_clock::now();
+    TbGenInfo info;
+    if (!generateTablebase(material, options.directory, options.threads, tables, info)) {
+        cerr << material.name() << ": не удалось построить таблицу\n";
+        return false;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << material.name() << ": " << info.legal << " позиций, выигрышей " << info.wins
+         << ", проигрышей " << info.losses << ", самый долгий мат " << info.longestMate
+         << " полуходов, " << info.passes << " проходов, "
+         << fixed << setprecision(1) << seconds << " с\n";
+    done.push_back(material.key());
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    vector<string> names;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-d") && i + 1 < argc) {
+            options.directory = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-f")) {
+            options.force = true;
+        }
+        else if (!strcmp(argv[i], "--verify") && i + 1 < argc) {
+            options.verify = atoi(argv[++i]);
+        }
+        else if (argv[i][0] != '-') {
+            names.push_back(argv[i]);
+        }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (options.threads < 1 || options.verify < 0) {
+        usage();
+        return 1;
+    }
+    if (names.empty()) {
+        names.assign(begin(DefaultTables), end(DefaultTables));
+    }
+
+    vector<TbMaterial> materials;
+    for (const string& name : names) {
+        TbMaterial material;
+        if (!TbMaterial::parse(name, material) || material.count < 3) {
+            cerr << "Неверный набор фигур: " << name << "\n";
+            return 1;
+        }
+        if (!material.isCanonical()) {
+            material = material.flipped();
+        }
+        materials.push_back(material);
+    }
+
+    error_code error;
+    filesystem::create_directories(options.directory, error);
+    initBitboards();
+
+    Tablebases tables;
+    vector<uint32_t> done;
+    for (const TbMaterial& material : materials) {
+        if (!buildTable(material, options, tables, done)) {
+            return 1;
+        }
+    }
+
+    int errors = 0;
+    if (options.verify > 0) {
+        for (const TbMaterial& material : materials) {
+            cout << "Проверка " << material.name() << "\n";
+            errors += verifyTable(material, tables, options.verify);
+        }
+    }
+    return errors ? 1 : 0;
+}
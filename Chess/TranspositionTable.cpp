@@ -0,0 +1,243 @@
+#include "TranspositionTable.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+const size_t MB = 1024 * 1024;
+const size_t HUGE_PAGE_SIZE = 2 * MB;
+
+// Упаковка записи: ход (16 бит), оценка (16), глубина (8), тип оценки (2), поколение (6)
+inline uint64_t packData(Move move, int score, int depth, Bound bound, uint8_t generation) {
+    return uint64_t(move)
+         | (uint64_t(uint16_t(int16_t(score))) << 16)
+         | (uint64_t(uint8_t(depth)) << 32)
+         | (uint64_t(bound) << 40)
+         | (uint64_t(generation) << 42);
+}
+
+inline Move dataMove(uint64_t data) { return Move(data & 0xFFFF); }
+inline int dataScore(uint64_t data) { return int16_t(uint16_t(data >> 16)); }
+inline int dataDepth(uint64_t data) { return int(uint8_t(data >> 32)); }
+inline Bound dataBound(uint64_t data) { return Bound((data >> 40) & 3); }
+inline uint8_t dataGeneration(uint64_t data) { return uint8_t((data >> 42) & 0x3F); }
+
+// Наибольшая степень двойки, не превосходящая n
+size_t floorPowerOfTwo(size_t n) {
+    size_t p = 1;
+    while (p * 2 <= n) {
+        p *= 2;
+    }
+    return p;
+}
+
+} // namespace
+
+TranspositionTable::TranspositionTable(size_t megabytes, bool hugePages) {
+    resize(megabytes, hugePages);
+}
+
+TranspositionTable::~TranspositionTable() {
+    release();
+}
+
+void TranspositionTable::release() {
+    switch (allocation) {
+#if defined(_WIN32)
+    case Allocation::LARGE_PAGES:
+        VirtualFree(buckets, 0, MEM_RELEASE);
+        break;
+    case Allocation::ALIGNED:
+        _aligned_free(buckets);
+        break;
+#else
+    case Allocation::MAPPED:
+        munmap(buckets, allocatedBytes);
+        break;
+    case Allocation::ALIGNED:
+    case Allocation::TRANSPARENT_HUGE:
+        std::free(buckets);
+        break;
+#endif
+    default:
+        break;
+    }
+    buckets = nullptr;
+    bucketCount = 0;
+    allocatedBytes = 0;
+    allocation = Allocation::NONE;
+}
+
+void* TranspositionTable::allocate(size_t bytes, bool hugePages) {
+    void* memory = nullptr;
+
+#if defined(_WIN32)
+    if (hugePages) {
+        // Требует права SeLockMemoryPrivilege; без него VirtualAlloc вернет NULL
+        SIZE_T largePage = GetLargePageMinimum();
+        if (largePage && bytes % largePage == 0) {
+            memory = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (memory) {
+                allocation = Allocation::LARGE_PAGES;
+            }
+        }
+    }
+    if (!memory) {
+        memory = _aligned_malloc(bytes, 64);
+        allocation = Allocation::ALIGNED;
+    }
+#else
+    // Большие страницы - только для размеров, кратных их размеру (таблица в 1 МБ - обычная)
+    if (hugePages && bytes % HUGE_PAGE_SIZE == 0) {
+#if defined(MAP_HUGETLB)
+        // Явные большие страницы (нужен заранее выделенный пул vm.nr_hugepages)
+        memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory == MAP_FAILED) {
+            memory = nullptr;
+        }
+        else {
+            allocation = Allocation::MAPPED;
+        }
+#endif
+        if (!memory) {
+            // Прозрачные большие страницы: достаточно выравнивания и подсказки ядру
+            memory = std::aligned_alloc(HUGE_PAGE_SIZE, bytes);
+            if (memory) {
+                allocation = Allocation::TRANSPARENT_HUGE;
+#if defined(MADV_HUGEPAGE)
+                madvise(memory, bytes, MADV_HUGEPAGE);
+#endif
+            }
+        }
+    }
+    if (!memory) {
+        memory = std::aligned_alloc(64, bytes);
+        allocation = Allocation::ALIGNED;
+    }
+#endif
+
+    if (!memory) {
+        allocation = Allocation::NONE;
+    }
+    return memory;
+}
+
+void TranspositionTable::resize(size_t megabytes, bool hugePages) {
+    release();
+
+    size_t bytes = floorPowerOfTwo(megabytes ? megabytes : 1) * MB;
+    void* memory = allocate(bytes, hugePages);
+    while (!memory && bytes > sizeof(Bucket)) {
+        bytes /= 2;
+        memory = allocate(bytes, hugePages);
+    }
+
+    if (memory) {
+        buckets = static_cast<Bucket*>(memory);
+        bucketCount = bytes / sizeof(Bucket);
+        allocatedBytes = bytes;
+    }
+    else {
+        // Память не выделилась совсем: probe и store работают с одной встроенной корзиной
+        buckets = &spare;
+        bucketCount = 1;
+        allocatedBytes = sizeof(Bucket);
+    }
+    clear();
+}
+
+void TranspositionTable::clear() {
+    if (buckets) {
+        memset(static_cast<void*>(buckets), 0, allocatedBytes);
+    }
+    generation = 0;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntryData& out, TTStats& stats) const {
+    ++stats.probes;
+    const Bucket& bucket = bucketFor(key);
+    for (const Entry& entry : bucket.entries) {
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        uint64_t check = entry.keyXorData.load(std::memory_order_relaxed);
+        if ((check ^ data) == key && dataBound(data) != Bound::NONE) {
+            out.move = dataMove(data);
+            out.score = dataScore(data);
+            out.depth = dataDepth(data);
+            out.bound = dataBound(data);
+            ++stats.hits;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, Move move, int score, int depth, Bound bound, TTStats& stats) {
+    ++stats.stores;
+    Bucket& bucket = bucketFor(key);
+
+    // Ищем запись этой же позиции; иначе вытесняем наименее ценную:
+    // из старого перебора и с наименьшей глубиной
+    Entry* replace = &bucket.entries[0];
+    uint64_t replaceData = 0;
+    int replaceWorth = 1 << 30;
+    bool sameKey = false;
+    for (Entry& entry : bucket.entries) {
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        uint64_t check = entry.keyXorData.load(std::memory_order_relaxed);
+        if ((check ^ data) == key) {
+            replace = &entry;
+            replaceData = data;
+            sameKey = true;
+            break;
+        }
+        int age = (generation - dataGeneration(data)) & 0x3F;
+        int worth = dataDepth(data) - 8 * age;
+        if (dataBound(data) == Bound::NONE) {
+            worth = -(1 << 20);
+        }
+        if (worth < replaceWorth) {
+            replace = &entry;
+            replaceData = data;
+            replaceWorth = worth;
+        }
+    }
+
+    if (sameKey) {
+        // Не затираем более глубокий результат той же позиции, но сохраняем лучший ход
+        if (move == MOVE_NONE) {
+            move = dataMove(replaceData);
+        }
+        if (bound != Bound::EXACT && dataDepth(replaceData) > depth + 2
+            && dataGeneration(replaceData) == generation) {
+            return;
+        }
+    }
+    else if (dataBound(replaceData) != Bound::NONE) {
+        ++stats.collisions;
+    }
+
+    uint64_t data = packData(move, score, depth, bound, generation);
+    replace->data.store(data, std::memory_order_relaxed);
+    replace->keyXorData.store(key ^ data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    size_t sample = bucketCount < 250 ? bucketCount : 250;
+    int used = 0;
+    for (size_t i = 0; i < sample; ++i) {
+        for (const Entry& entry : buckets[i].entries) {
+            uint64_t data = entry.data.load(std::memory_order_relaxed);
+            if (dataBound(data) != Bound::NONE && dataGeneration(data) == generation) {
+                ++used;
+            }
+        }
+    }
+    return sample ? int(used * 1000 / (sample * BUCKET_SIZE)) : 0;
+}
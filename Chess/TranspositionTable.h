@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "Move.h"
+
+// Тип оценки в таблице: точная, нижняя граница (отсечение) или верхняя граница
+enum class Bound : uint8_t { NONE, UPPER, LOWER, EXACT };
+
+// Распакованное содержимое записи
+struct TTEntryData {
+    Move move = MOVE_NONE;
+    int score = 0;
+    int depth = 0;
+    Bound bound = Bound::NONE;
+};
+
+// Статистика обращений. Каждый поток ведет свою копию, поэтому счетчики
+// не требуют синхронизации; при выводе копии складываются через merge()
+struct TTStats {
+    uint64_t probes = 0;      // Обращения на чтение
+    uint64_t hits = 0;        // Найдена запись для этой позиции
+    uint64_t stores = 0;      // Записи
+    uint64_t collisions = 0;  // Запись вытеснила другую позицию из корзины
+
+    void merge(const TTStats& other) {
+        probes += other.probes;
+        hits += other.hits;
+        stores += other.stores;
+        collisions += other.collisions;
+    }
+
+    double hitRate() const {
+        return probes ? double(hits) / double(probes) : 0.0;
+    }
+
+    double collisionRate() const {
+        return stores ? double(collisions) / double(stores) : 0.0;
+    }
+};
+
+// Общая хеш-таблица позиций без блокировок. Запись - два 64-битных атомарных
+// слова: данные и ключ, сложенный с данными по XOR. Если другой поток успел
+// переписать одно из слов, XOR не сойдется и запись будет считаться промахом.
+// Размер - степень двойки, корзина из 4 записей занимает одну линию кэша
+class TranspositionTable {
+private:
+    struct Entry {
+        std::atomic<uint64_t> keyXorData;
+        std::atomic<uint64_t> data;
+    };
+
+    static const int BUCKET_SIZE = 4;
+
+    struct alignas(64) Bucket {
+        Entry entries[BUCKET_SIZE];
+    };
+
+    // Способ, которым была выделена память (от него зависит освобождение):
+    // обычная, выровненная под прозрачные большие страницы Linux,
+    // явные большие страницы Linux (MAP_HUGETLB) или Windows (MEM_LARGE_PAGES)
+    enum class Allocation { NONE, ALIGNED, TRANSPARENT_HUGE, MAPPED, LARGE_PAGES };
+
+    Bucket* buckets = nullptr;
+    size_t bucketCount = 0;
+    size_t allocatedBytes = 0;
+    Allocation allocation = Allocation::NONE;
+    uint8_t generation = 0;   // Номер перебора: старые записи вытесняются первыми
+    Bucket spare;             // Таблица из одной корзины, если память не выделилась
+
+    // Выделение bytes байт (nullptr - не удалось); способ записывается в allocation
+    void* allocate(size_t bytes, bool hugePages);
+    void release();
+
+    Bucket& bucketFor(uint64_t key) const {
+        return buckets[key & (bucketCount - 1)];
+    }
+
+public:
+    // megabytes округляется вниз до степени двойки; hugePages - попытаться
+    // разместить таблицу в больших страницах (при неудаче - обычная память)
+    explicit TranspositionTable(size_t megabytes = 16, bool hugePages = false);
+    ~TranspositionTable();
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    // Изменение размера; содержимое при этом теряется. Если памяти не хватает,
+    // размер уменьшается вдвое, пока выделение не удастся
+    void resize(size_t megabytes, bool hugePages = false);
+
+    // Очистка всех записей (не потокобезопасна относительно перебора)
+    void clear();
+
+    // Вызывается в начале каждого нового перебора
+    void newSearch() {
+        generation = uint8_t((generation + 1) & 0x3F);
+    }
+
+    bool probe(uint64_t key, TTEntryData& out, TTStats& stats) const;
+    void store(uint64_t key, Move move, int score, int depth, Bound bound, TTStats& stats);
+
+    // Заполненность в промилле по выборке первых корзин (как UCI hashfull)
+    int hashfull() const;
+
+    size_t sizeBytes() const {
+        return allocatedBytes;
+    }
+
+    bool usesLargePages() const {
+        return allocation != Allocation::NONE && allocation != Allocation::ALIGNED;
+    }
+};
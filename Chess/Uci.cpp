@@ -0,0 +1,283 @@
+#include "Uci.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include "ChessBoard.h"
+#include "Profile.h"
+#include "SearchPool.h"
+#include "Tablebase.h"
+
+using namespace std;
+
+namespace {
+
+const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+const int DEFAULT_HASH_MB = 16;
+const int MAX_HASH_MB = 65536;
+const int MAX_THREADS = 512;
+const int64_t MOVE_OVERHEAD_MS = 30;   // Запас на задержки связи с оболочкой
+const int DEFAULT_MOVES_TO_GO = 30;    // Сколько ходов еще предстоит, если не сказано
+
+// Параметры команды go
+struct GoParams {
+    int64_t time[2] = { 0, 0 };    // wtime, btime
+    int64_t inc[2] = { 0, 0 };     // winc, binc
+    int movesToGo = 0;
+    int64_t moveTime = 0;
+    int depth = 0;
+    uint64_t nodes = 0;
+    bool infinite = false;
+    bool ponder = false;
+};
+
+class UciEngine {
+private:
+    istream& in;
+    ostream& out;
+    mutex outMutex;            // Вывод идет из потока ввода и из потока перебора
+
+    ChessBoard board;
+    TranspositionTable table{ DEFAULT_HASH_MB };
+    Tablebases tablebases;
+    SearchPool pool{ &table, 1 };
+
+    // Одна строка протокола целиком и сразу в канал
+    void send(const string& line) {
+        lock_guard<mutex> lock(outMutex);
+        out << line << "\n" << flush;
+    }
+
+    static string scoreString(int score) {
+        if (!isMateScore(score)) {
+            return "cp " + to_string(score);
+        }
+        int plies = MATE_SCORE - abs(score);
+        int moves = score > 0 ? (plies + 1) / 2 : -(plies / 2);
+        return "mate " + to_string(moves);
+    }
+
+    void sendInfo(const SearchResult& result) {
+        uint64_t nodes = pool.nodesSearched();
+        int64_t timeMs = result.timeMs;
+        ostringstream line;
+        line << "info depth " << result.depth
+             << " score " << scoreString(result.score)
+             << " nodes " << nodes
+             << " nps " << (timeMs > 0 ? nodes * 1000 / uint64_t(timeMs) : nodes * 1000)
+             << " time " << timeMs
+             << " hashfull " << table.hashfull()
+             << " tbhits " << pool.tablebaseHits()
+             << " pv " << moveToString(result.bestMove);
+        send(line.str());
+    }
+
+    // Бюджет времени на ход: равная доля оставшегося времени плюс половина добавки
+    static int64_t allocateTime(const GoParams& go, int us) {
+        if (go.moveTime > 0) {
+            return max<int64_t>(1, go.moveTime - MOVE_OVERHEAD_MS);
+        }
+        if (go.time[us] <= 0) {
+            return 0;
+        }
+        int movesToGo = go.movesToGo > 0 ? go.movesToGo : DEFAULT_MOVES_TO_GO;
+        int64_t budget = go.time[us] / movesToGo + go.inc[us] / 2;
+        int64_t maxBudget = go.time[us] - MOVE_OVERHEAD_MS;
+        return max<int64_t>(1, min(budget, maxBudget));
+    }
+
+    void cmdUci() {
+        send("id name Chess");
+        send("id author Chess contributors");
+        send("option name Hash type spin default " + to_string(DEFAULT_HASH_MB)
+             + " min 1 max " + to_string(MAX_HASH_MB));
+        send("option name Threads type spin default 1 min 1 max " + to_string(MAX_THREADS));
+        send("option name Ponder type check default false");
+        send("option name TablebasePath type string default <empty>");
+        send("uciok");
+    }
+
+    // setoption name <имя> value <значение>
+    void cmdSetOption(istringstream& args) {
+        string token, name, value;
+        args >> token;   // name
+        while (args >> token && token != "value") {
+            name += (name.empty() ? "" : " ") + token;
+        }
+        // Значение - остаток строки: путь может содержать пробелы
+        getline(args >> ws, value);
+
+        pool.stop();
+        pool.wait();
+        if (name == "Hash") {
+            int mb = clamp(atoi(value.c_str()), 1, MAX_HASH_MB);
+            table.resize(size_t(mb));
+        }
+        else if (name == "Threads") {
+            pool.setThreads(clamp(atoi(value.c_str()), 1, MAX_THREADS));
+        }
+        else if (name == "TablebasePath") {
+            pool.setTablebases(nullptr);
+            tablebases.clear();
+            if (!value.empty() && value != "<empty>") {
+                int loaded = tablebases.load(value);
+                send("info string tablebases loaded: " + to_string(loaded));
+            }
+            pool.setTablebases(tablebases.tableCount() ? &tablebases : nullptr);
+        }
+    }
+
+    // position startpos | fen <FEN> [moves <ход>...]
+    void cmdPosition(istringstream& args) {
+        string token, fen;
+        args >> token;
+        if (token == "startpos") {
+            fen = START_FEN;
+            args >> token;
+        }
+        else if (token == "fen") {
+            while (args >> token && token != "moves") {
+                fen += (fen.empty() ? "" : " ") + token;
+            }
+        }
+        else {
+            return;
+        }
+
+        if (!board.loadFen(fen)) {
+            send("info string invalid fen " + fen);
+            return;
+        }
+        if (token != "moves") {
+            return;
+        }
+        while (args >> token) {
+            Move move = board.parseMove(token);
+            if (move == MOVE_NONE) {
+                send("info string illegal move " + token);
+                return;
+            }
+            board.makeMove(move);
+        }
+    }
+
+    void cmdGo(istringstream& args) {
+        GoParams go;
+        string token;
+        while (args >> token) {
+            if (token == "wtime") args >> go.time[0];
+            else if (token == "btime") args >> go.time[1];
+            else if (token == "winc") args >> go.inc[0];
+            else if (token == "binc") args >> go.inc[1];
+            else if (token == "movestogo") args >> go.movesToGo;
+            else if (token == "movetime") args >> go.moveTime;
+            else if (token == "depth") args >> go.depth;
+            else if (token == "nodes") args >> go.nodes;
+            else if (token == "infinite") go.infinite = true;
+            else if (token == "ponder") go.ponder = true;
+        }
+
+        SearchLimits limits;
+        limits.depth = go.depth;
+        limits.nodes = go.nodes;
+        if (!go.infinite) {
+            limits.moveTimeMs = allocateTime(go, board.sideToMove() == Color::WHITE ? 0 : 1);
+        }
+
+        // Ход выдается только по stop, если перебор бесконечный
+        pool.start(board, limits, go.ponder || go.infinite);
+    }
+
+    // Итоги счетчиков профиля: в файл (JSON или CSV по расширению) или строками info string
+    void cmdProfile(istringstream& args) {
+        if (!profileEnabled()) {
+            send("info string profiling disabled, build with CHESS_PROFILE");
+            return;
+        }
+        string path;
+        if (args >> path) {
+            send(string("info string profile ") + (profileWriteFile(path) ? "written to " : "write failed ") + path);
+            return;
+        }
+        ostringstream report;
+        profileWrite(report, ProfileFormat::CSV);
+        istringstream lines(report.str());
+        string line;
+        while (getline(lines, line)) {
+            send("info string " + line);
+        }
+    }
+
+public:
+    UciEngine(istream& input, ostream& output) : in(input), out(output) {
+        board.loadFen(START_FEN);
+        pool.onIteration = [this](const SearchResult& result) {
+            sendInfo(result);
+        };
+        pool.onFinish = [this](const SearchResult& result) {
+            send("bestmove " + (result.bestMove != MOVE_NONE ? moveToString(result.bestMove) : string("0000")));
+        };
+    }
+
+    int loop() {
+        string line;
+        while (getline(in, line)) {
+            istringstream args(line);
+            string command;
+            args >> command;
+
+            if (command == "uci") {
+                cmdUci();
+            }
+            else if (command == "isready") {
+                send("readyok");
+            }
+            else if (command == "setoption") {
+                cmdSetOption(args);
+            }
+            else if (command == "ucinewgame") {
+                pool.stop();
+                pool.clear();
+            }
+            else if (command == "position") {
+                cmdPosition(args);
+            }
+            else if (command == "go") {
+                cmdGo(args);
+            }
+            else if (command == "stop") {
+                pool.stop();
+            }
+            else if (command == "ponderhit") {
+                pool.ponderhit();
+            }
+            else if (command == "quit") {
+                break;
+            }
+            else if (command == "d") {
+                send(board.toFen());
+            }
+            else if (command == "profile") {
+                cmdProfile(args);
+            }
+            else if (!command.empty()) {
+                send("info string unknown command " + command);
+            }
+        }
+
+        pool.stop();
+        pool.wait();
+        return 0;
+    }
+};
+
+} // namespace
+
+int runUci(istream& in, ostream& out) {
+    UciEngine engine(in, out);
+    return engine.loop();
+}
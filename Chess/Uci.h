@@ -0,0 +1,8 @@
+#pragma once
+
+#include <iostream>
+
+// Работа движка по протоколу UCI без консольного интерфейса. Команды читаются
+// из in в вызывающем потоке, пока перебор идет в пуле потоков, поэтому stop
+// прерывает перебор сразу. Возвращает код завершения программы
+int runUci(std::istream& in = std::cin, std::ostream& out = std::cout);
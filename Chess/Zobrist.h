@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+// Случайные ключи Зобриста для хеширования позиции
+struct ZobristKeys {
+    uint64_t piece[2][6][64]; // [цвет][тип фигуры][клетка]
+    uint64_t side;            // Ход черных
+    uint64_t castling[16];    // Комбинация прав на рокировку (биты KQkq)
+    uint64_t enPassant[8];    // Вертикаль взятия на проходе
+};
+
+// Генератор splitmix64: дает хорошо перемешанные 64-битные числа и работает в constexpr
+inline constexpr uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+inline constexpr ZobristKeys makeZobristKeys() {
+    ZobristKeys keys{};
+    uint64_t state = 0x5A0B415D2E3C1F07ULL;
+    for (int c = 0; c < 2; ++c) {
+        for (int t = 0; t < 6; ++t) {
+            for (int sq = 0; sq < 64; ++sq) {
+                keys.piece[c][t][sq] = splitMix64(state);
+            }
+        }
+    }
+    keys.side = splitMix64(state);
+    for (int i = 0; i < 16; ++i) {
+        keys.castling[i] = splitMix64(state);
+    }
+    for (int i = 0; i < 8; ++i) {
+        keys.enPassant[i] = splitMix64(state);
+    }
+    return keys;
+}
+
+// Ключи считаются на этапе компиляции и одинаковы во всех сборках
+inline constexpr ZobristKeys Zobrist = makeZobristKeys();